@@ -0,0 +1,69 @@
+#include <chrono>
+
+#include "scene/systems/TransformSystem.hpp"
+#include "jobs/ThreadPool.hpp"
+
+/* Times a full TransformSystem::update() over a large parented scene with 1, 2, 4 and 8 threads */
+
+static vector<entt::entity> populate(entt::registry& reg, u32 roots, u32 fanout, u32 depth)
+{
+	vector<entt::entity> ret(roots), level, next;
+	reg.create(ret.begin(), ret.end());
+	reg.insert<TransformComponent>(ret.begin(), ret.end());
+	level = ret;
+
+	for (u32 d = 1; d < depth; ++d)
+	{
+		next.clear();
+		for (auto parent: level)
+		{
+			for (u32 i = 0; i < fanout; ++i)
+			{
+				auto child = reg.create();
+				reg.emplace<TransformComponent>(child)
+				   .set_parent(entt::const_handle{reg, parent})
+				   .apply_transform(f32dquat::translation({f32(i), 1.f, 0.f}) *
+				                    f32dquat::rotation(f32deg{f32(i) * 10.f}, f32vec3::zAxis()));
+				next.push_back(child);
+			}
+		}
+		std::swap(level, next);
+	}
+
+	return ret;
+}
+
+int main(int argc, char** argv)
+{
+	const u32 roots = argc > 1 ? u32(std::stoul(argv[1])) : 1000;
+	const u32 iterations = 100;
+
+	entt::registry reg;
+	const vector<entt::entity> rootEntities = populate(reg, roots, 4, 5);
+
+	Debug{} << "Transform update," << reg.storage<TransformComponent>().size() << "entities," << iterations
+	        << "iterations";
+
+	for (u32 threads: {1u, 2u, 4u, 8u})
+	{
+		ThreadPool pool{threads};
+		TransformSystem system;
+		system.update(reg, &pool);
+
+		f32 angle = 0.f;
+		auto start = std::chrono::steady_clock::now();
+		for (u32 i = 0; i < iterations; ++i)
+		{
+			/* Moving every root dirties the whole scene */
+			angle += 1.f;
+			for (auto root: rootEntities)
+			{ reg.get<TransformComponent>(root).set_transform(f32dquat::rotation(f32deg{angle}, f32vec3::yAxis())); }
+			system.update(reg, &pool);
+		}
+		std::chrono::duration<f64, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+		Debug{} << threads << "thread(s):" << elapsed.count() / iterations << "ms per update";
+	}
+
+	return 0;
+}
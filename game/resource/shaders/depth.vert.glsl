@@ -0,0 +1,20 @@
+layout(location = POSITION_ATTRIBUTE_LOCATION) in vec3 aPos;
+#ifdef INSTANCED_TRANSFORMATION
+layout(location = TRANSFORMATION_MATRIX_ATTRIBUTE_LOCATION) in mat4 aInstancedModel;
+#endif
+
+// same expressions as pbr.vert.glsl, the shading pass tests against this depth with equality
+invariant gl_Position;
+
+void main()
+{
+#ifdef INSTANCED_TRANSFORMATION
+	mat4 transformation = aInstancedModel;
+#else
+	mat4 transformation = mat4(1.0);
+#endif
+
+	vec3 WorldPos = vec3(transformation * vec4(aPos, 1.0));
+
+	gl_Position =  viewProjection * vec4(WorldPos, 1.0);
+}
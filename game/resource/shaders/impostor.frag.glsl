@@ -0,0 +1,56 @@
+flat in vec3 Center;
+flat in float Radius;
+flat in vec3 Color;
+in vec3 WorldPos;
+
+layout(location = 1) uniform vec3 ambientColor;
+
+// the PhongGL light buffer, laid out as Magnum::Shaders::PhongLightUniform
+struct PhongLight
+{
+	vec4 position;
+	vec3 color;
+	uint reserved;
+	vec3 specularColor;
+	float range;
+};
+
+layout(std430, binding = PHONG_LIGHT_BUFFER_BINDING) readonly buffer PhongLights
+{
+	PhongLight phongLights[];
+};
+
+out vec4 FragColor;
+
+void main()
+{
+	vec3 direction = normalize(WorldPos - cameraPosition.xyz);
+	vec3 oc = cameraPosition.xyz - Center;
+
+	// distance to the ray from its closest point, stays precise with planets millions of units away
+	float b = dot(oc, direction);
+	vec3 closest = oc - b * direction;
+	float h = Radius * Radius - dot(closest, closest);
+	if (h < 0.0)
+		discard;
+
+	float t = -b - sqrt(h);
+	vec3 N = (oc + direction * t) / Radius;
+	vec3 position = cameraPosition.xyz + direction * t;
+
+	// the diffuse part of PhongGL with VertexColor, so nothing jumps when the entity switches to its impostor; the
+	// specular highlight would only cover a fraction of the few pixels an impostor gets
+	vec3 color = ambientColor * Color;
+	for (uint i = 0u; i < uint(phongLights.length()); ++i)
+	{
+		vec3 L = phongLights[i].position.xyz - position * phongLights[i].position.w;
+		float distance = length(L);
+		float window = clamp(1.0 - pow(distance / max(phongLights[i].range, 0.0001), 4.0), 0.0, 1.0);
+		float attenuation = window * window / (1.0 + distance * distance);
+		color += Color * phongLights[i].color * max(dot(N, normalize(L)), 0.0) * attenuation;
+	}
+
+	vec4 clip = viewProjection * vec4(position, 1.0);
+	gl_FragDepth = clip.z / clip.w;
+	FragColor = vec4(color, 1.0);
+}
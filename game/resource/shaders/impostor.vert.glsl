@@ -0,0 +1,28 @@
+layout(location = POSITION_ATTRIBUTE_LOCATION) in vec3 aPos;
+layout(location = TRANSFORMATION_MATRIX_ATTRIBUTE_LOCATION) in mat4 aInstancedModel;
+layout(location = COLOR_ATTRIBUTE_LOCATION) in vec4 aColor;
+
+flat out vec3 Center;
+flat out float Radius;
+flat out vec3 Color;
+out vec3 WorldPos;
+
+void main()
+{
+	// the instance transformation is a translation to the sphere center scaled by its radius
+	Center = aInstancedModel[3].xyz;
+	Radius = length(aInstancedModel[0].xyz);
+	Color = aColor.rgb;
+
+	vec3 toCenter = Center - cameraPosition.xyz;
+	float dist = length(toCenter);
+	vec3 forward = toCenter / dist;
+	vec3 right = normalize(cross(forward, abs(forward.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+	vec3 up = cross(right, forward);
+
+	// the quad goes through the center facing the eye, its half extent reaches the tangent cone of the sphere
+	float extent = Radius * dist / sqrt(max(dist * dist - Radius * Radius, 1e-6 * dist * dist));
+
+	WorldPos = Center + (right * aPos.x + up * aPos.y) * extent;
+	gl_Position = viewProjection * vec4(WorldPos, 1.0);
+}
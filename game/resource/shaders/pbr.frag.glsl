@@ -3,20 +3,18 @@ in vec2 TexCoords;
 in vec3 WorldPos;
 in vec3 Normal;
 
-// material parameters
-layout(binding = 0) uniform sampler2D albedoMap;
-layout(binding = 1) uniform sampler2D normalMap;
-layout(binding = 2) uniform sampler2D metallicMap;
-layout(binding = 3) uniform sampler2D roughnessMap;
-layout(binding = 4) uniform sampler2D aoMap;
-layout(binding = 5) uniform sampler2D emissiveMap;
-
-layout(location = 2) uniform vec3 camPos;
-layout(location = 3) uniform float emissivePower;
-
-// lights
-layout(location = 10) uniform vec3 lightPositions[LIGHT_COUNT];
-layout(location = LIGHT_COLORS_LOCATION) uniform vec3 lightColors[LIGHT_COUNT];
+// material parameters, one MaterialLibrary page, the layer of the draw is its material
+layout(binding = 0) uniform sampler2DArray albedoMap;
+layout(binding = 1) uniform sampler2DArray normalMap;
+layout(binding = 2) uniform sampler2DArray metallicMap;
+layout(binding = 3) uniform sampler2DArray roughnessMap;
+layout(binding = 4) uniform sampler2DArray aoMap;
+layout(binding = 5) uniform sampler2DArray emissiveMap;
+
+vec3 materialCoords()
+{
+	return vec3(TexCoords, float(draws[drawOffset].material.x));
+}
 
 const float PI = 3.14159265359;
 // ----------------------------------------------------------------------------
@@ -26,7 +24,7 @@ const float PI = 3.14159265359;
 // technique somewhere later in the normal mapping tutorial.
 vec3 getNormalFromMap()
 {
-	vec3 tangentNormal = texture(normalMap, TexCoords).xyz * 2.0 - 1.0;
+	vec3 tangentNormal = texture(normalMap, materialCoords()).xyz * 2.0 - 1.0;
 
 	vec3 Q1  = dFdx(WorldPos);
 	vec3 Q2  = dFdy(WorldPos);
@@ -81,15 +79,25 @@ vec3 fresnelSchlick(float cosTheta, vec3 F0)
 	return F0 + (1.0 - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
 }
 // ----------------------------------------------------------------------------
+// froxel holding this fragment, slices are exponential in view depth past clusterParameters.z
+uint clusterIndex()
+{
+	uvec2 tile = min(uvec2(gl_FragCoord.xy / clusterParameters.xy * vec2(clusterSize.xy)), clusterSize.xy - 1u);
+	float depth = max(dot(WorldPos - cameraPosition.xyz, cameraForward.xyz), clusterParameters.z);
+	uint slice = uint(min(log(depth / clusterParameters.z) * clusterParameters.w, float(clusterSize.z - 1u)));
+	return (slice * clusterSize.y + tile.y) * clusterSize.x + tile.x;
+}
+// ----------------------------------------------------------------------------
 void main()
 {
-	vec3 albedo     = pow(texture(albedoMap, TexCoords).rgb, vec3(2.2));
-	float metallic  = texture(metallicMap, TexCoords).r;
-	float roughness = texture(roughnessMap, TexCoords).r;
-	float ao        = texture(aoMap, TexCoords).r;
+	vec3 uvw        = materialCoords();
+	vec3 albedo     = pow(texture(albedoMap, uvw).rgb, vec3(2.2));
+	float metallic  = texture(metallicMap, uvw).r;
+	float roughness = texture(roughnessMap, uvw).r;
+	float ao        = texture(aoMap, uvw).r;
 
 	vec3 N = getNormalFromMap();
-	vec3 V = normalize(camPos - WorldPos);
+	vec3 V = normalize(cameraPosition.xyz - WorldPos);
 
 	// calculate reflectance at normal incidence; if dia-electric (like plastic) use F0
 	// of 0.04 and if it's a metal, use the albedo color as F0 (metallic workflow)
@@ -98,14 +106,18 @@ void main()
 
 	// reflectance equation
 	vec3 Lo = vec3(0.0);
-	for (int i = 0; i < LIGHT_COUNT; ++i)
+	uvec2 cluster = clusters[clusterIndex()];
+	for (uint c = 0u; c < cluster.y; ++c)
 	{
-		// calculate per-light radiance
-		vec3 L = normalize(lightPositions[i] - WorldPos);
+		Light light = lights[lightIndices[cluster.x + c]];
+
+		// calculate per-light radiance, windowed to reach zero at the light range
+		vec3 L = normalize(light.position.xyz - WorldPos);
 		vec3 H = normalize(V + L);
-		float distance = length(lightPositions[i] - WorldPos);
-		float attenuation = 1.0 / (distance * distance);
-		vec3 radiance = lightColors[i] * attenuation;
+		float distance = length(light.position.xyz - WorldPos);
+		float window = clamp(1.0 - pow(distance / light.position.w, 4.0), 0.0, 1.0);
+		float attenuation = window * window / (distance * distance);
+		vec3 radiance = light.color.rgb * attenuation;
 
 		// Cook-Torrance BRDF
 		float NDF = DistributionGGX(N, H, roughness);
@@ -138,9 +150,10 @@ void main()
 	// this ambient lighting with environment lighting).
 	vec3 ambient = vec3(0.03) * albedo * ao;
 	vec3 emissive = vec3(0.0);
+	float emissivePower = uintBitsToFloat(draws[drawOffset].material.y);
 	if (emissivePower > 0)
 	{
-		emissive = texture(emissiveMap, TexCoords).rgb * emissivePower;
+		emissive = texture(emissiveMap, materialCoords()).rgb * emissivePower;
 	}
 
 	vec3 color = ambient + Lo + emissive;
@@ -0,0 +1,46 @@
+// per-frame data, bound once, its leading matrix doubles as the projection of the Magnum shaders
+layout(std140, binding = FRAME_BUFFER_BINDING) uniform Frame
+{
+	mat4 viewProjection;
+	vec4 cameraPosition;
+	vec4 cameraForward;
+	// xy viewport size, z first cluster slice depth, w slices per unit of log depth
+	vec4 clusterParameters;
+	uvec4 clusterSize;
+};
+
+// per-draw data, x of material is the layer of the material textures, y the bits of the emissive power
+struct Draw
+{
+	uvec4 material;
+};
+
+layout(std430, binding = DRAW_BUFFER_BINDING) readonly buffer Draws
+{
+	Draw draws[];
+};
+
+layout(location = 0) uniform uint drawOffset;
+
+// clustered lights, w of position is the range
+struct Light
+{
+	vec4 position;
+	vec4 color;
+};
+
+layout(std430, binding = LIGHT_BUFFER_BINDING) readonly buffer Lights
+{
+	Light lights[];
+};
+
+// offset and count into lightIndices for every cluster
+layout(std430, binding = CLUSTER_BUFFER_BINDING) readonly buffer Clusters
+{
+	uvec2 clusters[];
+};
+
+layout(std430, binding = LIGHT_INDEX_BUFFER_BINDING) readonly buffer LightIndices
+{
+	uint lightIndices[];
+};
@@ -1,19 +1,28 @@
 layout(location = POSITION_ATTRIBUTE_LOCATION) in vec3 aPos;
 layout(location = NORMAL_ATTRIBUTE_LOCATION) in vec3 aNormal;
 layout(location = TEXTURECOORDINATES_ATTRIBUTE_LOCATION) in vec2 aTexCoords;
+#ifdef INSTANCED_TRANSFORMATION
+layout(location = TRANSFORMATION_MATRIX_ATTRIBUTE_LOCATION) in mat4 aInstancedModel;
+#endif
+
+// must match depth.vert.glsl bit for bit, the pre-pass depth is tested with equality
+invariant gl_Position;
 
 out vec2 TexCoords;
 out vec3 WorldPos;
 out vec3 Normal;
 
-layout(location = 0) uniform mat4 projView;
-layout(location = 1) uniform mat4 model;
-
 void main()
 {
+#ifdef INSTANCED_TRANSFORMATION
+	mat4 transformation = aInstancedModel;
+#else
+	mat4 transformation = mat4(1.0);
+#endif
+
 	TexCoords = aTexCoords;
-	WorldPos = vec3(model * vec4(aPos, 1.0));
-	Normal = mat3(model) * aNormal;
+	WorldPos = vec3(transformation * vec4(aPos, 1.0));
+	Normal = mat3(transformation) * aNormal;
 
-	gl_Position =  projView * vec4(WorldPos, 1.0);
+	gl_Position =  viewProjection * vec4(WorldPos, 1.0);
 }
@@ -27,25 +27,17 @@ AbstractImContext::AbstractImContext(ImGuiContext& context, ImPlotContext& plotC
 		: _context{&context}, _plotCtx{&plotCtx},
 		  _shader{Shaders::FlatGL2D::Configuration{}
 				          .setFlags(Shaders::FlatGL2D::Flag::Textured | Shaders::FlatGL2D::Flag::VertexColor)},
-		  _size{size}
+		  _stream{ImStreamBuffer::shared()}, _size{size}
 {
 	makeCurrent();
 
 	ImGuiIO& io = ImGui::GetIO();
 	io.BackendFlags |= ImGuiBackendFlags_HasMouseCursors;
+	/* Draws offset their base vertex, lists may go past 64k vertices with 16 bit indices */
+	io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
 
 	relayout(size, windowSize, framebufferSize);
 
-	_mesh.setPrimitive(GL::MeshPrimitive::Triangles);
-	_mesh.addVertexBuffer(_vertexBuffer, 0,
-	                      Shaders::FlatGL2D::Position{},
-	                      Shaders::FlatGL2D::TextureCoordinates{},
-	                      Shaders::FlatGL2D::Color4{
-			                      Shaders::FlatGL2D::Color4::DataType::UnsignedByte,
-			                      Shaders::FlatGL2D::Color4::DataOption::Normalized
-	                      }
-	);
-
 	_timeline.start();
 }
 
@@ -54,15 +46,13 @@ AbstractImContext::AbstractImContext(ImGuiContext& context, ImPlotContext& plotC
 {}
 
 AbstractImContext::AbstractImContext(Magnum::NoCreateT) noexcept
-		: _context{nullptr}, _plotCtx{nullptr}, _shader{NoCreate}, _texture{NoCreate}, _vertexBuffer{NoCreate},
-		  _indexBuffer{NoCreate},
-		  _mesh{NoCreate}
+		: _context{nullptr}, _plotCtx{nullptr}, _shader{NoCreate}, _texture{NoCreate}, _mesh{NoCreate}
 {}
 
 AbstractImContext::AbstractImContext(AbstractImContext&& other) noexcept
 		: _context{other._context}, _plotCtx{other._plotCtx}, _shader{std::move(other._shader)},
 		  _texture{std::move(other._texture)},
-		  _vertexBuffer{std::move(other._vertexBuffer)}, _indexBuffer{std::move(other._indexBuffer)},
+		  _stream{std::move(other._stream)}, _streamGeneration{other._streamGeneration},
 		  _timeline{other._timeline}, _mesh{std::move(other._mesh)}, _size{other._size},
 		  _supersamplingRatio{other._supersamplingRatio}, _eventScaling{other._eventScaling}
 {
@@ -96,8 +86,8 @@ AbstractImContext& AbstractImContext::operator=(AbstractImContext&& other) noexc
 	std::swap(_plotCtx, other._plotCtx);
 	std::swap(_shader, other._shader);
 	std::swap(_texture, other._texture);
-	std::swap(_vertexBuffer, other._vertexBuffer);
-	std::swap(_indexBuffer, other._indexBuffer);
+	std::swap(_stream, other._stream);
+	std::swap(_streamGeneration, other._streamGeneration);
 	std::swap(_timeline, other._timeline);
 	std::swap(_mesh, other._mesh);
 	std::swap(_size, other._size);
@@ -214,6 +204,12 @@ void AbstractImContext::newFrame()
 	_mousePressedInThisFrame = {};
 }
 
+void AbstractImContext::endFrame()
+{
+	makeCurrent();
+	ImGui::EndFrame();
+}
+
 void AbstractImContext::drawFrame()
 {
 	makeCurrent();
@@ -234,40 +230,86 @@ void AbstractImContext::drawFrame()
 			f32mat3::scaling({1.f, -1.f});
 	_shader.setTransformationProjectionMatrix(projection);
 
+	/* Every list of the frame in one allocation, vertices first; their size is a multiple of sizeof(ImDrawVert), so
+	 * the indices following them stay aligned */
+	const std::size_t vertexSize = std::size_t(drawData->TotalVtxCount) * sizeof(ImDrawVert);
+	const std::size_t indexSize = std::size_t(drawData->TotalIdxCount) * sizeof(ImDrawIdx);
+
+	const ImStreamBuffer::Allocation allocation = _stream->reserve(vertexSize + indexSize, sizeof(ImDrawVert));
+	setupMesh();
+
+	std::size_t vertexCursor = 0, indexCursor = vertexSize;
 	for (std::int_fast32_t n = 0; n < drawData->CmdListsCount; ++n)
 	{
 		const ImDrawList* cmdList = drawData->CmdLists[n];
-		ImDrawIdx indexBufferOffset = 0;
+		const std::size_t listVertexSize = std::size_t(cmdList->VtxBuffer.Size) * sizeof(ImDrawVert);
+		const std::size_t listIndexSize = std::size_t(cmdList->IdxBuffer.Size) * sizeof(ImDrawIdx);
+		std::memcpy(allocation.data.data() + vertexCursor, cmdList->VtxBuffer.Data, listVertexSize);
+		std::memcpy(allocation.data.data() + indexCursor, cmdList->IdxBuffer.Data, listIndexSize);
+		vertexCursor += listVertexSize;
+		indexCursor += listIndexSize;
+	}
 
-		_vertexBuffer.setData({cmdList->VtxBuffer.Data, std::size_t(cmdList->VtxBuffer.Size)},
-		                      GL::BufferUsage::StreamDraw);
-		_indexBuffer.setData({cmdList->IdxBuffer.Data, std::size_t(cmdList->IdxBuffer.Size)},
-		                     GL::BufferUsage::StreamDraw);
+	/* Base vertex and index offset locate each list in the allocation, scissor and texture only change when they
+	 * differ from the previous command */
+	std::size_t baseVertex = allocation.offset / sizeof(ImDrawVert);
+	std::size_t baseIndex = (allocation.offset + vertexSize) / sizeof(ImDrawIdx);
+	optional<i32range2> scissor;
+	ImTextureID texture = nullptr;
+	for (std::int_fast32_t n = 0; n < drawData->CmdListsCount; ++n)
+	{
+		const ImDrawList* cmdList = drawData->CmdLists[n];
 
 		for (std::int_fast32_t c = 0; c < cmdList->CmdBuffer.Size; ++c)
 		{
 			const ImDrawCmd* pcmd = &cmdList->CmdBuffer[c];
 
-			GL::Renderer::setScissor(i32range2{f32range2{
+			const i32range2 clip{f32range2{
 					{pcmd->ClipRect.x, fbSize.y() - pcmd->ClipRect.w},
-					{pcmd->ClipRect.z, fbSize.y() - pcmd->ClipRect.y}}
-					                                   .scaled(_supersamplingRatio)});
-
-			_mesh.setCount(bit_cast<i32>(pcmd->ElemCount));
-			_mesh.setIndexBuffer(_indexBuffer, indexBufferOffset * sizeof(ImDrawIdx),
-			                     sizeof(ImDrawIdx) == 2
-			                     ? GL::MeshIndexType::UnsignedShort
-			                     : GL::MeshIndexType::UnsignedInt);
-
-			indexBufferOffset += pcmd->ElemCount;
-
-			_shader.bindTexture(*static_cast<GL::Texture2D*>(pcmd->TextureId)).draw(_mesh);
+					{pcmd->ClipRect.z, fbSize.y() - pcmd->ClipRect.y}}.scaled(_supersamplingRatio)};
+			if (scissor != clip)
+			{
+				GL::Renderer::setScissor(clip);
+				scissor = clip;
+			}
+
+			if (texture != pcmd->TextureId)
+			{
+				_shader.bindTexture(*static_cast<GL::Texture2D*>(pcmd->TextureId));
+				texture = pcmd->TextureId;
+			}
+
+			_mesh.setCount(bit_cast<i32>(pcmd->ElemCount))
+			     .setBaseVertex(i32(baseVertex + pcmd->VtxOffset))
+			     .setIndexOffset(i32(baseIndex + pcmd->IdxOffset));
+			_shader.draw(_mesh);
 		}
+
+		baseVertex += std::size_t(cmdList->VtxBuffer.Size);
+		baseIndex += std::size_t(cmdList->IdxBuffer.Size);
 	}
 
 	GL::Renderer::setScissor(i32range2{f32range2{{}, fbSize}.scaled(_supersamplingRatio)});
 }
 
+void AbstractImContext::setupMesh()
+{
+	if (_streamGeneration == _stream->generation())
+	{ return; }
+
+	_streamGeneration = _stream->generation();
+	_mesh = GL::Mesh{GL::MeshPrimitive::Triangles};
+	_mesh.addVertexBuffer(_stream->buffer(), 0,
+	                      Shaders::FlatGL2D::Position{},
+	                      Shaders::FlatGL2D::TextureCoordinates{},
+	                      Shaders::FlatGL2D::Color4{
+			                      Shaders::FlatGL2D::Color4::DataType::UnsignedByte,
+			                      Shaders::FlatGL2D::Color4::DataOption::Normalized
+	                      })
+	     .setIndexBuffer(_stream->buffer(), 0,
+	                     sizeof(ImDrawIdx) == 2 ? GL::MeshIndexType::UnsignedShort : GL::MeshIndexType::UnsignedInt);
+}
+
 bool AbstractImContext::handleKeyEvent(KeyCode key, bool pressed)
 {
 	makeCurrent();
@@ -10,6 +10,7 @@
 #include <implot.h>
 #include <imgui.h>
 
+#include "ImStreamBuffer.hpp"
 #include "../Types.hpp"
 
 using MouseButton = Magnum::Platform::GlfwApplication::MouseEvent::Button;
@@ -101,6 +102,10 @@ public:
 	Magnum::GL::Texture2D& atlasTexture()
 	{ return _texture; }
 
+	/* Shared by every context, the application ends its frames once all of them drew */
+	ImStreamBuffer& streamBuffer()
+	{ return *_stream; }
+
 	[[nodiscard]] f32vec2 size() const
 	{ return _size; }
 
@@ -112,6 +117,9 @@ public:
 
 	virtual void drawFrame();
 
+	/* Ends the frame without rendering it, for a context nobody can see */
+	void endFrame();
+
 protected:
 	explicit AbstractImContext(f32vec2 const& size, i32vec2 const& windowSize, i32vec2 const& framebufferSize);
 
@@ -125,6 +133,9 @@ protected:
 
 	explicit AbstractImContext(Magnum::NoCreateT) noexcept;
 
+	/* Points _mesh at the current buffer of _stream */
+	void setupMesh();
+
 	bool handleKeyEvent(KeyCode key, bool pressed);
 
 	bool handleMouseEvent(MouseButton button, i32vec2 position, bool pressed);
@@ -133,8 +144,9 @@ protected:
 	ImPlotContext* _plotCtx;
 	Magnum::Shaders::FlatGL2D _shader;
 	Magnum::GL::Texture2D _texture{Magnum::NoCreate};
-	Magnum::GL::Buffer _vertexBuffer{Magnum::GL::Buffer::TargetHint::Array};
-	Magnum::GL::Buffer _indexBuffer{Magnum::GL::Buffer::TargetHint::ElementArray};
+	std::shared_ptr<ImStreamBuffer> _stream;
+	/* Generation of _stream the vertex and index buffers of _mesh point to */
+	u32 _streamGeneration{0};
 	Magnum::Timeline _timeline;
 	Magnum::GL::Mesh _mesh;
 	f32vec2 _size, _supersamplingRatio, _eventScaling;
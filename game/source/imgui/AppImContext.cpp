@@ -1 +1,44 @@
+#include "../scene/GpuProfiler.hpp"
 #include "AppImContext.hpp"
+
+void AppImContext::drawProfiler(GpuProfiler const& profiler, bool* open)
+{
+	makeCurrent();
+
+	ImGui::SetNextWindowSize(ImVec2{420.f, 360.f}, ImGuiCond_FirstUseEver);
+	if (ImGui::Begin("GPU Passes", open))
+	{
+		if (ImPlot::BeginPlot("##history", ImVec2{-1.f, 220.f}, ImPlotFlags_NoMouseText))
+		{
+			ImPlot::SetupAxes(nullptr, "ms", ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit);
+			ImPlot::SetupAxisLimits(ImAxis_X1, 0.0, f64(GpuProfiler::History), ImPlotCond_Always);
+			/* Starting at head plots the ring oldest sample first */
+			for (GpuProfiler::Pass const& pass: profiler.passes())
+			{
+				ImPlot::PlotLine(pass.name.c_str(), pass.samples.data(), i32(GpuProfiler::History), 1.0, 0.0, 0,
+				                 i32(pass.head));
+			}
+			ImPlot::EndPlot();
+		}
+
+		if (ImGui::BeginTable("##times", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp))
+		{
+			ImGui::TableSetupColumn("Pass");
+			ImGui::TableSetupColumn("Last (ms)");
+			ImGui::TableSetupColumn("Average (ms)");
+			ImGui::TableHeadersRow();
+			for (GpuProfiler::Pass const& pass: profiler.passes())
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(pass.name.c_str());
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", pass.last);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", pass.average);
+			}
+			ImGui::EndTable();
+		}
+	}
+	ImGui::End();
+}
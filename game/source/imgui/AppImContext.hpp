@@ -2,6 +2,8 @@
 
 #include "AbstractImContext.hpp"
 
+class GpuProfiler;
+
 class AppImContext : public AbstractImContext
 {
 public:
@@ -26,6 +28,9 @@ public:
 			: AbstractImContext{NoCreate}
 	{}
 
+	/* HUD window plotting the rolling history of every profiled pass, with its last and average time */
+	void drawProfiler(GpuProfiler const& profiler, bool* open = nullptr);
+
 	template<class MouseEvent>
 	inline bool handleMousePressEvent(MouseEvent& event)
 	{ return handleMouseEvent(event.button(), event.position(), true); }
@@ -0,0 +1,85 @@
+#include "ImStreamBuffer.hpp"
+
+using namespace Magnum;
+
+std::shared_ptr<ImStreamBuffer> ImStreamBuffer::shared()
+{
+	static std::weak_ptr<ImStreamBuffer> instance{};
+
+	std::shared_ptr<ImStreamBuffer> ret = instance.lock();
+	if (!ret)
+	{
+		ret = std::make_shared<ImStreamBuffer>();
+		instance = ret;
+	}
+	return ret;
+}
+
+ImStreamBuffer::ImStreamBuffer(std::size_t regionSize)
+{
+	reallocate(regionSize);
+}
+
+ImStreamBuffer::~ImStreamBuffer()
+{
+	for (GLsync fence: _fences)
+	{
+		if (fence)
+		{ glDeleteSync(fence); }
+	}
+}
+
+ImStreamBuffer::Allocation ImStreamBuffer::reserve(std::size_t size, std::size_t alignment)
+{
+	const std::size_t start = _region * _regionSize;
+	std::size_t offset = (start + _cursor + alignment - 1) / alignment * alignment;
+	if (offset + size > start + _regionSize)
+	{
+		/* Whatever this frame wrote so far stays in the old buffer with the draws that use it */
+		reallocate(Math::max(2 * _regionSize, 2 * (size + alignment)));
+		offset = (_region * _regionSize + alignment - 1) / alignment * alignment;
+	}
+
+	_cursor = offset + size - _region * _regionSize;
+	return {offset, _mapped.sliceSize(offset, size)};
+}
+
+void ImStreamBuffer::endFrame()
+{
+	_fences[_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	_region = (_region + 1) % Regions;
+	_cursor = 0;
+
+	/* Written Regions - 1 frames ago, only a GPU that far behind makes this wait */
+	GLsync& fence = _fences[_region];
+	if (fence)
+	{
+		while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000) == GL_TIMEOUT_EXPIRED)
+		{}
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+}
+
+void ImStreamBuffer::reallocate(std::size_t regionSize)
+{
+	/* The fences guarded regions of the old buffer, the new one is entirely free */
+	for (GLsync& fence: _fences)
+	{
+		if (fence)
+		{ glDeleteSync(fence); }
+		fence = nullptr;
+	}
+
+	_regionSize = regionSize;
+	_cursor = 0;
+	_buffer = GL::Buffer{GL::Buffer::TargetHint::Array};
+	_buffer.setStorage({nullptr, Regions * regionSize}, GL::Buffer::StorageFlag::MapWrite |
+	                                                   GL::Buffer::StorageFlag::MapPersistent |
+	                                                   GL::Buffer::StorageFlag::MapCoherent);
+	_mapped = _buffer.map(0, GLsizeiptr(Regions * regionSize), GL::Buffer::MapFlag::Write |
+	                                                           GL::Buffer::MapFlag::Persistent |
+	                                                           GL::Buffer::MapFlag::Coherent);
+	CORRADE_INTERNAL_ASSERT(_mapped.data());
+	++_generation;
+}
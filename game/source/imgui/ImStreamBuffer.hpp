@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Corrade/Containers/ArrayView.h>
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/OpenGL.h>
+#include <memory>
+
+#include "../Types.hpp"
+
+/* Streaming storage for the geometry of every ImGui context. One persistently and coherently mapped buffer is split in
+ * Regions, one per frame in flight: draw lists are copied straight into the region of the current frame, and
+ * endFrame() fences it before moving on to the next one, which is normally long done by then. A frame outgrowing its
+ * region reallocates the buffer twice as large; draws already issued keep the old one alive, so nothing waits. */
+class ImStreamBuffer
+{
+public:
+	static constexpr u32 Regions = 3;
+
+	struct Allocation
+	{
+		/* Offset in buffer(), a multiple of the requested alignment */
+		std::size_t offset;
+		Corrade::Containers::ArrayView<char> data;
+	};
+
+	/* The instance shared by every live AbstractImContext, created on first use */
+	static std::shared_ptr<ImStreamBuffer> shared();
+
+	explicit ImStreamBuffer(std::size_t regionSize = 1024 * 1024);
+
+	~ImStreamBuffer();
+
+	ImStreamBuffer(ImStreamBuffer const&) = delete;
+
+	ImStreamBuffer& operator=(ImStreamBuffer const&) = delete;
+
+	/* size bytes of the current region to write to, valid until the next call */
+	Allocation reserve(std::size_t size, std::size_t alignment);
+
+	/* Fences what this frame wrote, call once after every context drew */
+	void endFrame();
+
+	Magnum::GL::Buffer& buffer()
+	{ return _buffer; }
+
+	/* Changes whenever buffer() gets reallocated, meshes sourcing it must be set up again */
+	[[nodiscard]] u32 generation() const
+	{ return _generation; }
+
+private:
+	Magnum::GL::Buffer _buffer{NoCreate};
+	Corrade::Containers::ArrayView<char> _mapped{};
+	array<GLsync, Regions> _fences{};
+	std::size_t _regionSize{0};
+	std::size_t _cursor{0};
+	u32 _region{0};
+	u32 _generation{0};
+
+	void reallocate(std::size_t regionSize);
+};
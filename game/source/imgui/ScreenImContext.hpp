@@ -2,6 +2,7 @@
 
 #include <Magnum/GL/Renderbuffer.h>
 #include <Magnum/GL/Framebuffer.h>
+#include <entt/entity/entity.hpp>
 #include <entt/entity/fwd.hpp>
 #include <utility>
 
@@ -29,6 +30,10 @@ public:
 	Magnum::GL::Texture2D& color()
 	{ return _color; }
 
+	/* Reads back the UI color */
+	Magnum::GL::Framebuffer& framebuffer()
+	{ return _fb; }
+
 	void drawFrame() override;
 
 	void processCamera(f32dquat transform, f32dquat cam, bool is_control);
@@ -49,6 +54,14 @@ struct ScreenComponent
 	string title;
 	function<void(entt::const_handle)> fn;
 
+	/* Inputs of the last ScreenImContext::processCamera() call */
+	entt::entity camera{entt::null};
+	u32 cameraVersion{0}, screenVersion{0};
+	bool cameraControl{false};
+
+	/* GpuProfiler pass timing the draws of the screen, registered by the first frame that draws it */
+	optional<u32> profilerPass{};
+
 	explicit ScreenComponent(Magnum::NoCreateT)
 			: context{NoCreate}, title{}, fn{}
 	{}
@@ -0,0 +1,99 @@
+#include "ThreadPool.hpp"
+
+ThreadPool::ThreadPool(u32 threadCount)
+{
+	for (u32 i = 1; i < threadCount; ++i)
+	{
+		_workers.emplace_back([this]()
+		                      { run(); });
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard lock{_mutex};
+		_stopping = true;
+	}
+	_wake.notify_all();
+
+	for (auto& worker: _workers)
+	{ worker.join(); }
+}
+
+void ThreadPool::parallelFor(std::size_t count, std::size_t grain, function<void(std::size_t, std::size_t)> const& fn)
+{
+	grain = std::max<std::size_t>(grain, 1);
+	const std::size_t chunks = (count + grain - 1) / grain;
+	if (chunks <= 1 || _workers.empty())
+	{
+		if (count > 0)
+		{ fn(0, count); }
+		return;
+	}
+
+	/* Helpers may start after the caller already drained every chunk, so the state outlives this call */
+	struct State
+	{
+		std::atomic<std::size_t> next{0}, done{0};
+		std::mutex mutex{};
+		std::condition_variable finished{};
+	};
+	auto state = std::make_shared<State>();
+
+	auto work = [state, chunks, count, grain, &fn]()
+	{
+		for (std::size_t chunk = state->next++; chunk < chunks; chunk = state->next++)
+		{
+			fn(chunk * grain, std::min(count, (chunk + 1) * grain));
+			if (++state->done == chunks)
+			{
+				std::lock_guard lock{state->mutex};
+				state->finished.notify_all();
+			}
+		}
+	};
+
+	for (std::size_t i = 0, helpers = std::min(chunks - 1, _workers.size()); i < helpers; ++i)
+	{ push(work); }
+	work();
+
+	std::unique_lock lock{state->mutex};
+	state->finished.wait(lock, [&state, chunks]()
+	{ return state->done == chunks; });
+}
+
+void ThreadPool::push(function<void()> job)
+{
+	/* Nobody would ever pick it up */
+	if (_workers.empty())
+	{
+		job();
+		return;
+	}
+
+	{
+		std::lock_guard lock{_mutex};
+		_queue.push_back(std::move(job));
+	}
+	_wake.notify_one();
+}
+
+void ThreadPool::run()
+{
+	for (;;)
+	{
+		function<void()> job;
+		{
+			std::unique_lock lock{_mutex};
+			_wake.wait(lock, [this]()
+			{ return _stopping || !_queue.empty(); });
+			if (_stopping && _queue.empty())
+			{ return; }
+
+			job = std::move(_queue.front());
+			_queue.pop_front();
+		}
+		job();
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <deque>
+#include <mutex>
+
+#include "../Types.hpp"
+
+/* Fixed set of worker threads fed from a single queue. parallelFor() splits a range in chunks and lets the
+ * calling thread work on it too, so a pool of N workers runs on N + 1 cores. */
+class ThreadPool
+{
+	vector<std::thread> _workers{};
+	std::deque<function<void()>> _queue{};
+	std::mutex _mutex{};
+	std::condition_variable _wake{};
+	bool _stopping{false};
+
+public:
+	/* Total thread count, including the thread calling parallelFor() */
+	explicit ThreadPool(u32 threadCount = std::max(1u, std::thread::hardware_concurrency()));
+
+	~ThreadPool();
+
+	ThreadPool(ThreadPool const&) = delete;
+
+	ThreadPool& operator=(ThreadPool const&) = delete;
+
+	[[nodiscard]] u32 threadCount() const
+	{ return u32(_workers.size()) + 1; }
+
+	void parallelFor(std::size_t count, std::size_t grain, function<void(std::size_t, std::size_t)> const& fn);
+
+	template<class Fn>
+	auto submit(Fn&& fn) -> std::future<std::invoke_result_t<Fn>>
+	{
+		auto task = std::make_shared<std::packaged_task<std::invoke_result_t<Fn>()>>(std::forward<Fn>(fn));
+		auto ret = task->get_future();
+		push([task]()
+		     { (*task)(); });
+		return ret;
+	}
+
+private:
+	void push(function<void()> job);
+
+	void run();
+};
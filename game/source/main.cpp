@@ -1,9 +1,6 @@
 #include <Magnum/Platform/GlfwApplication.h>
 #include <Magnum/GL/DefaultFramebuffer.h>
 #include <Magnum/Primitives/UVSphere.h>
-#include <Magnum/MeshTools/Transform.h>
-#include <Magnum/MeshTools/Compile.h>
-#include <Magnum/MeshTools/Copy.h>
 #include <Magnum/Trade/MeshData.h>
 #include <Magnum/GL/DebugOutput.h>
 #include <Magnum/GL/Renderer.h>
@@ -12,6 +9,7 @@
 #include "imgui/ScreenImContext.hpp"
 #include "imgui/AppImContext.hpp"
 #include "scene/gameplay/PlayerShip.h"
+#include "scene/FrameCapture.hpp"
 #include "scene/Scene.hpp"
 
 using namespace Magnum;
@@ -55,16 +53,16 @@ public:
 		_time.start();
 
 		_scene.create(framebufferSize());
+		_imguiPass = _scene.profiler().pass("ImGui");
+		_capture = std::make_shared<FrameCapture>("capture");
 		_ship.create(_scene);
 		_camParent = _scene.createEntity();
 		_rusted_ball = _scene.createEntity();
 		_cam = _scene.createEntity();
 
 		_rusted_ball.emplace<MeshComponent>(
-				[](GL::Mesh* mesh)
-				{ *mesh = MeshTools::compile(Primitives::uvSphereSolid(24, 24, Primitives::UVSphereFlag::TextureCoordinates)); });
-		_rusted_ball.emplace<PhysicalMaterialComponent>("assets/textures/rusted_metal")
-		            .loadTextures();
+				_scene.meshes().uvSphereSolid(24, 24, Primitives::UVSphereFlag::TextureCoordinates));
+		_rusted_ball.emplace<PhysicalMaterialComponent>(_scene.materials().load("assets/textures/rusted_metal"));
 
 		_cam.emplace<CameraComponent>(Scene::createReverseProjectionMatrix(
 				60.0_degf,
@@ -77,43 +75,31 @@ public:
 				.set_parent(_ship.root());
 		_cam.get<TransformComponent>().set_parent(_camParent);
 
-		_scene.phongShader().setLightColor(0, 0xffffff_rgbf)
-		      .setLightPosition(0, {0.f, 3.f, 3.4f, 1.f})
-			  .setLightRange(0, 2500.f)
-		      .setAmbientColor(0x202020_rgbf);
+		auto light = _scene.createEntity();
+		light.emplace<LightComponent>(0xffffff_rgbf, 150.f, 2500.f);
+		light.get<TransformComponent>()
+		     .apply_transform(f32dquat::translation({0.f, 3.f, 3.4f}));
 
-		_scene.physicalShader().setLightParameters(0, {0.f, 3.f, 3.4f}, {150.f, 150.f, 150.f});
+		_scene.setAmbientColor(0x202020_rgbf);
 
 		const f32 earthRadius = 6'378'000.f, moonRadius = 1'737'500.f;
 
 		auto earth = _scene.createEntity();
 		earth.emplace<PhongMaterialComponent>(0x275f91_rgbf);
 		earth.get<TransformComponent>()
-		     .apply_transform(f32dquat::translation(f32vec3::yAxis(-earthRadius - 1.f)));
-		earth.emplace<MeshComponent>(
-				[earthRadius](GL::Mesh* mesh)
-				{
-					auto data = MeshTools::copy(Primitives::uvSphereSolid(30, 30));
-					MeshTools::transformPointsInPlace(f32mat4::scaling({earthRadius, earthRadius, earthRadius}),
-					                                  data.mutableAttribute<f32vec3>(Trade::MeshAttribute::Position));
-					*mesh = MeshTools::compile(data);
-				}
-		);
+		     .apply_transform(f64dquat::translation(f64vec3::yAxis(-f64(earthRadius) - 1.0)));
+		earth.emplace<PlanetComponent>(std::make_shared<PlanetTerrain>(earthRadius));
+		/* Shrunk clear of the chords of the coarsest terrain chunks */
+		earth.emplace<OccluderComponent>(OccluderComponent::sphere(0.99f * earthRadius));
 
 		auto moon = _scene.createEntity();
 		moon.emplace<PhongMaterialComponent>(0xe6ea98_rgbf);
 		moon.get<TransformComponent>()
 		    .set_parent(earth)
-		    .apply_transform(f32dquat::translation(f32vec3::yAxis(384'400'000.f)));
-		moon.emplace<MeshComponent>(
-				[moonRadius](GL::Mesh* mesh)
-				{
-					auto data = MeshTools::copy(Primitives::uvSphereSolid(30, 30));
-					MeshTools::transformPointsInPlace(f32mat4::scaling({moonRadius, moonRadius, moonRadius}),
-					                                  data.mutableAttribute<f32vec3>(Trade::MeshAttribute::Position));
-					*mesh = MeshTools::compile(data);
-				}
-		);
+		    .apply_transform(f64dquat::translation(f64vec3::yAxis(384'400'000.0)));
+		moon.emplace<MeshComponent>(_scene.meshes().uvSphereSolid(30, 30)).set_scale(moonRadius);
+		moon.emplace<ImpostorComponent>();
+		moon.emplace<OccluderComponent>(OccluderComponent::sphere(0.99f * moonRadius));
 	}
 
 	virtual ~AsteropeGame() = default;
@@ -125,14 +111,24 @@ private:
 	Scene _scene{NoCreate};
 	PlayerShip _ship{NoCreate};
 	entt::handle _cam, _camParent, _rusted_ball;
+	/* Lives as long as the application so stopping never waits on the disk; shared with the readbacks in flight */
+	std::shared_ptr<FrameCapture> _capture{};
+	u32 _captureSession{0};
 
 	f32deg _camPitch{-45.f}, _camYaw{0.f};
-	bool _camControl{false}, _testToggle{false};
+	u32 _imguiPass{0};
+	bool _camControl{false}, _testToggle{false}, _showProfiler{false};
 
 	void drawEvent() override
 	{
+		_scene.profiler().beginFrame();
 		updateCamera();
 		_scene.render(_cam, _camControl);
+		if (_capture->isCapturing())
+		{
+			_scene.readColor({{}, _scene.renderSize()}, [capture = _capture, session = _captureSession](Image2D&& image)
+			{ capture->push(session, std::move(image)); });
+		}
 
 		GL::defaultFramebuffer
 				.clearColor(0xa5c9ea_rgbf)
@@ -143,7 +139,11 @@ private:
 		{ _ctx.updateApplicationCursor(*this); }
 
 		_ctx.newFrame();
+		if (_showProfiler)
+		{ _ctx.drawProfiler(_scene.profiler(), &_showProfiler); }
 		renderMainImgui();
+		_ctx.streamBuffer().endFrame();
+		_scene.profiler().endFrame();
 
 		swapBuffers();
 		redraw();
@@ -163,6 +163,26 @@ private:
 				return;
 			}
 
+			if (event.key() == KeyEvent::Key::F2)
+			{ _scene.setDepthPrePass(!_scene.depthPrePass()); }
+
+			if (event.key() == KeyEvent::Key::F3)
+			{ _scene.resolution().setEnabled(!_scene.resolution().isEnabled()); }
+
+			if (event.key() == KeyEvent::Key::F4)
+			{ _showProfiler = !_showProfiler; }
+
+			if (event.key() == KeyEvent::Key::F5)
+			{
+				if (_capture->isCapturing())
+				{ _capture->stop(); }
+				else
+				{ _captureSession = _capture->start(); }
+			}
+
+			if (event.key() == KeyEvent::Key::F6)
+			{ _scene.occlusion().setEnabled(!_scene.occlusion().isEnabled()); }
+
 			if (event.key() == KeyEvent::Key::LeftAlt)
 			{
 				if (_camControl)
@@ -238,47 +258,50 @@ private:
 
 	void updateCamera()
 	{
-		_cam.get<TransformComponent>().transform = f32dquat::rotation(_camYaw, f32vec3::yAxis()) *
-		                                           f32dquat::rotation(_camPitch, f32vec3::xAxis());
+		_cam.get<TransformComponent>().set_transform(f32dquat::rotation(_camYaw, f32vec3::yAxis()) *
+		                                             f32dquat::rotation(_camPitch, f32vec3::xAxis()));
+		_scene.updateTransforms();
 
 		if (_camControl)
 		{
-			f32mat4 m = _cam.get<TransformComponent>().world_transform().toMatrix();
+			f64mat4 m = _cam.get<TransformComponent>().world_transform().toMatrix();
 			auto& cam = _camParent.get<TransformComponent>();
-			float rate = _time.previousFrameDuration() *
-			             (glfwGetKey(window(), GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS ? 2000.f : 2.f);
+			f64 rate = _time.previousFrameDuration() *
+			           (glfwGetKey(window(), GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS ? 2000.0 : 2.0);
 
 			if (glfwGetKey(window(), GLFW_KEY_W) == GLFW_PRESS)
 			{
-				cam.apply_transform(f32dquat::translation(-m.backward() * rate));
+				cam.apply_transform(f64dquat::translation(-m.backward() * rate));
 			}
 			if (glfwGetKey(window(), GLFW_KEY_S) == GLFW_PRESS)
 			{
-				cam.apply_transform(f32dquat::translation(m.backward() * rate));
+				cam.apply_transform(f64dquat::translation(m.backward() * rate));
 			}
 
 			if (glfwGetKey(window(), GLFW_KEY_D) == GLFW_PRESS)
 			{
-				cam.apply_transform(f32dquat::translation(m.right() * rate));
+				cam.apply_transform(f64dquat::translation(m.right() * rate));
 			}
 			if (glfwGetKey(window(), GLFW_KEY_A) == GLFW_PRESS)
 			{
-				cam.apply_transform(f32dquat::translation(-m.right() * rate));
+				cam.apply_transform(f64dquat::translation(-m.right() * rate));
 			}
 
 			if (glfwGetKey(window(), GLFW_KEY_SPACE) == GLFW_PRESS)
 			{
-				cam.apply_transform(f32dquat::translation(f32vec3::yAxis(rate)));
+				cam.apply_transform(f64dquat::translation(f64vec3::yAxis(rate)));
 			}
 			if (glfwGetKey(window(), GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS)
 			{
-				cam.apply_transform(f32dquat::translation(f32vec3::yAxis(-rate)));
+				cam.apply_transform(f64dquat::translation(f64vec3::yAxis(-rate)));
 			}
 		}
 	}
 
 	void renderMainImgui()
 	{
+		auto timing = _scene.profiler().scope(_imguiPass);
+
 		GL::Renderer::disable(GL::Renderer::Feature::DepthTest);
 		GL::Renderer::enable(GL::Renderer::Feature::Blending);
 		GL::Renderer::enable(GL::Renderer::Feature::ScissorTest);
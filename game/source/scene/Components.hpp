@@ -1,42 +1,71 @@
 #pragma once
 
 #include <entt/entity/handle.hpp>
-#include <Magnum/GL/Texture.h>
+#include <Magnum/Trade/Trade.h>
 #include <Magnum/GL/Mesh.h>
 #include <utility>
+#include <memory>
 
 #include "Types.hpp"
 
 struct TransformComponent
 {
-	f32dquat transform{IdentityInit};
 	entt::const_handle parent{};
 
 	TransformComponent() = default;
 
-	[[nodiscard]] f32dquat world_transform() const
-	{
-		if (parent)
-		{
-			return parent.get<TransformComponent>().transform * transform;
-		}
-		else
-		{
-			return transform;
-		}
-	}
+	explicit TransformComponent(f64dquat const& local) : _local{local}
+	{}
+
+	[[nodiscard]] f64dquat const& local_transform() const
+	{ return _local; }
+
+	/* Cached by TransformSystem::update(), stale until the next update after a change */
+	[[nodiscard]] f64dquat const& world_transform() const
+	{ return _world; }
+
+	[[nodiscard]] u32 depth() const
+	{ return _depth; }
+
+	/* Bumped every time the world transform gets recomputed */
+	[[nodiscard]] u32 version() const
+	{ return _version; }
 
 	TransformComponent& set_parent(entt::const_handle const& handle)
 	{
 		parent = handle;
+		_depth = parent ? parent.get<TransformComponent>()._depth + 1 : 0;
+		_dirty = true;
 		return *this;
 	}
 
-	TransformComponent& apply_transform(f32dquat const& dq)
+	TransformComponent& set_transform(f64dquat const& dq)
+	{
+		_local = dq;
+		_dirty = true;
+		return *this;
+	}
+
+	TransformComponent& set_transform(f32dquat const& dq)
+	{ return set_transform(f64dquat{dq}); }
+
+	TransformComponent& apply_transform(f64dquat const& dq)
 	{
-		transform = transform * dq;
+		_local = _local * dq;
+		_dirty = true;
 		return *this;
 	}
+
+	TransformComponent& apply_transform(f32dquat const& dq)
+	{ return apply_transform(f64dquat{dq}); }
+
+private:
+	friend class TransformSystem;
+
+	f64dquat _local{IdentityInit};
+	f64dquat _world{IdentityInit};
+	u32 _depth{0}, _slot{0}, _version{0};
+	bool _dirty{true}, _updated{false};
 };
 
 struct CameraComponent
@@ -50,20 +79,123 @@ struct CameraComponent
 	{}
 };
 
+struct LightComponent
+{
+	f32col3 color;
+	f32 intensity, range;
+
+	explicit LightComponent(f32col3 Color = {1.f, 1.f, 1.f}, f32 Intensity = 1.f,
+	                        f32 Range = f32const::inf())
+			: color{Color}, intensity{Intensity}, range{Range}
+	{}
+};
+
+/* GPU geometry shared by every MeshComponent copied from the one that built it. Instanced draws read their
+ * per-instance attributes from the buffer named by instanceBuffer, attached to mesh the first time it gets drawn
+ * and indexed through the base instance. */
+struct GpuMesh
+{
+	Magnum::GL::Mesh mesh{};
+	u32 instanceBuffer{0};
+};
+
+/* Coarser stand-in for the geometry of a MeshComponent */
+struct MeshLod
+{
+	std::shared_ptr<GpuMesh> gpu;
+	/* Largest distance of this level's surface from the full detail one, in mesh space */
+	f32 error;
+};
+
 struct MeshComponent
 {
-	Magnum::GL::Mesh mesh;
+	std::shared_ptr<GpuMesh> gpu;
+	/* Levels of detail below gpu, by increasing error */
+	vector<MeshLod> lods{};
+	/* Bounding sphere in mesh space, infinite when the geometry is unknown */
+	f32vec3 center{};
+	f32 radius{f32const::inf()};
+	/* Uniform scale applied before the entity transform, lets differently sized bodies share one mesh */
+	f32 scale{1.f};
+
+	explicit MeshComponent(Magnum::NoCreateT)
+	{}
+
+	explicit MeshComponent(function<void(Magnum::GL::Mesh*)> const& buildFn) : gpu{std::make_shared<GpuMesh>()}
+	{ buildFn(&gpu->mesh); }
 
-	explicit MeshComponent(Magnum::NoCreateT) : mesh{NoCreate}
+	explicit MeshComponent(Magnum::Trade::MeshData const& data);
+
+	MeshComponent(std::shared_ptr<GpuMesh> Gpu, f32vec3 const& Center, f32 Radius, vector<MeshLod> Lods = {})
+			: gpu{std::move(Gpu)}, lods{std::move(Lods)}, center{Center}, radius{Radius}
 	{}
 
-	explicit MeshComponent(function<void(Magnum::GL::Mesh*)> const& buildFn)
+	MeshComponent& set_scale(f32 s)
+	{
+		scale = s;
+		return *this;
+	}
+
+	[[nodiscard]] f32vec3 scaled_center() const
+	{ return center * scale; }
+
+	[[nodiscard]] f32 scaled_radius() const
+	{ return radius * scale; }
+
+	/* Coarsest level whose scaled error stays within maxError, the full detail mesh when none does */
+	[[nodiscard]] GpuMesh* lod_for(f32 maxError) const
 	{
-		mesh = Magnum::GL::Mesh{};
-		buildFn(&mesh);
+		GpuMesh* ret = gpu.get();
+		for (MeshLod const& lod: lods)
+		{
+			if (lod.error * scale > maxError)
+			{ break; }
+			ret = lod.gpu.get();
+		}
+		return ret;
 	}
 };
 
+/* Draws the bounding sphere of the MeshComponent as an analytically shaded billboard, in the PhongMaterialComponent
+ * diffuse color, once its projected diameter drops below threshold pixels */
+struct ImpostorComponent
+{
+	f32 threshold;
+
+	explicit ImpostorComponent(f32 Threshold = 16.f) : threshold{Threshold}
+	{}
+};
+
+/* Shape OcclusionCuller rasterizes to hide what is behind the entity, in entity space without the MeshComponent
+ * scale. Triangles are single sided, counter-clockwise from where they occlude, and must stay inside what the entity
+ * draws: a shape poking out of it would hide visible geometry. */
+struct OccluderComponent
+{
+	/* Three vertices per triangle */
+	vector<f32vec3> triangles;
+	/* Around the entity origin, enclosing every vertex */
+	f32 radius;
+
+	explicit OccluderComponent(vector<f32vec3> Triangles);
+
+	/* Polyhedron with its vertices on the sphere, so its faces lie inside it */
+	static OccluderComponent sphere(f32 radius, u32 rings = 8);
+
+	static OccluderComponent box(f32vec3 const& halfExtents);
+};
+
+class PlanetTerrain;
+
+/* Planet surface drawn by Scene from the camera-refined chunks of terrain, with the PhongMaterialComponent diffuse
+ * color when there is one */
+struct PlanetComponent
+{
+	std::shared_ptr<PlanetTerrain> terrain;
+
+	explicit PlanetComponent(std::shared_ptr<PlanetTerrain> Terrain) : terrain{std::move(Terrain)}
+	{}
+};
+
 struct PhongMaterialComponent
 {
 	f32col3 diffuse;
@@ -72,17 +204,13 @@ struct PhongMaterialComponent
 	{}
 };
 
+struct PhysicalMaterial;
+
+/* Material of the Scene MaterialLibrary, entities sharing one draw in the same batches */
 struct PhysicalMaterialComponent
 {
-	Magnum::GL::Texture2D albedo{NoCreate};
-	Magnum::GL::Texture2D ambientOcclusion{NoCreate};
-	Magnum::GL::Texture2D metallic{NoCreate};
-	Magnum::GL::Texture2D normal{NoCreate};
-	Magnum::GL::Texture2D roughness{NoCreate};
-	string path;
-
-	explicit PhysicalMaterialComponent(string texturesPath) : path{std::move(texturesPath)}
-	{}
+	PhysicalMaterial const* material;
 
-	void loadTextures();
+	explicit PhysicalMaterialComponent(PhysicalMaterial const& Material) : material{&Material}
+	{}
 };
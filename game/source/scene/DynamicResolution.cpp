@@ -0,0 +1,64 @@
+#include "DynamicResolution.hpp"
+
+using namespace Magnum;
+
+DynamicResolution::DynamicResolution(f64 budget) : _budget{budget}
+{
+	for (GL::TimeQuery& query: _queries)
+	{ query = GL::TimeQuery{GL::TimeQuery::Target::TimeElapsed}; }
+}
+
+DynamicResolution& DynamicResolution::setEnabled(bool enabled)
+{
+	_enabled = enabled;
+	if (!enabled)
+	{ _scale = _maxScale; }
+	return *this;
+}
+
+DynamicResolution& DynamicResolution::setScaleRange(f32 min, f32 max)
+{
+	CORRADE_ASSERT(0.f < min && min <= max && max <= 1.f,
+	               "DynamicResolution::setScaleRange(): expected 0 < min <= max <= 1, got" << min << max, *this);
+	_minScale = min;
+	_maxScale = max;
+	_scale = Math::clamp(_scale, min, max);
+	return *this;
+}
+
+void DynamicResolution::beginFrame()
+{
+	const u32 slot = _frame % Latency;
+	_timing = false;
+	if (_issued[slot])
+	{
+		/* Latency frames old by now, a driver that still isn't done only costs timing this frame */
+		if (!_queries[slot].resultAvailable())
+		{ return; }
+
+		const f64 seconds = f64(_queries[slot].result<u64>()) * 1e-9;
+		_gpuTime = _gpuTime > 0.0 ? Math::lerp(_gpuTime, seconds, 0.1) : seconds;
+
+		if (_enabled && _gpuTime > 0.0)
+		{
+			const f32 target = _scale * f32(Math::sqrt(Headroom * _budget / _gpuTime));
+			_scale = Math::clamp(Math::clamp(target, _scale - MaxStep, _scale + MaxStep), _minScale, _maxScale);
+		}
+	}
+
+	_queries[slot].begin();
+	_issued[slot] = true;
+	_timing = true;
+}
+
+void DynamicResolution::endFrame()
+{
+	if (_timing)
+	{ _queries[_frame % Latency].end(); }
+	++_frame;
+}
+
+i32vec2 DynamicResolution::apply(i32vec2 const& size) const
+{
+	return Math::max(i32vec2{f32vec2{size} * _scale + f32vec2{0.5f}}, i32vec2{1});
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Magnum/GL/TimeQuery.h>
+
+#include "../Types.hpp"
+
+/* Picks the render resolution from measured GPU frame time. Frames are timed with a ring of time elapsed queries read
+ * back Latency frames later, so measuring never stalls the pipeline. The pixel count follows the ratio of the frame
+ * budget to the smoothed GPU time, the resolution scale being its square root, and moves by at most MaxStep a frame
+ * so the image doesn't pump. */
+class DynamicResolution
+{
+public:
+	static constexpr u32 Latency = 3;
+	static constexpr f32 MaxStep = 0.05f;
+	/* Fraction of the budget aimed for, leaves room for the work after the timed part of the frame */
+	static constexpr f64 Headroom = 0.9;
+
+	explicit DynamicResolution(NoCreateT) noexcept
+	{}
+
+	explicit DynamicResolution(f64 budget = 1.0 / 60.0);
+
+	DynamicResolution& setEnabled(bool enabled);
+
+	[[nodiscard]] bool isEnabled() const
+	{ return _enabled; }
+
+	/* Seconds of GPU time a frame may take */
+	DynamicResolution& setBudget(f64 seconds)
+	{
+		_budget = seconds;
+		return *this;
+	}
+
+	DynamicResolution& setScaleRange(f32 min, f32 max);
+
+	[[nodiscard]] f32 scale() const
+	{ return _scale; }
+
+	/* Smoothed seconds of GPU time between beginFrame() and endFrame(), 0 until the first result comes back */
+	[[nodiscard]] f64 gpuTime() const
+	{ return _gpuTime; }
+
+	/* Reads back the oldest query and adapts the scale, then starts timing */
+	void beginFrame();
+
+	void endFrame();
+
+	/* size scaled down by scale(), never empty */
+	[[nodiscard]] i32vec2 apply(i32vec2 const& size) const;
+
+private:
+	array<Magnum::GL::TimeQuery, Latency> _queries{
+			Magnum::GL::TimeQuery{NoCreate}, Magnum::GL::TimeQuery{NoCreate}, Magnum::GL::TimeQuery{NoCreate}};
+	array<bool, Latency> _issued{};
+	u32 _frame{0};
+	bool _timing{false};
+	bool _enabled{true};
+	f64 _budget{1.0 / 60.0};
+	f64 _gpuTime{0.0};
+	f32 _scale{1.f}, _minScale{0.5f}, _maxScale{1.f};
+};
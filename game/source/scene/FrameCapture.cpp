@@ -0,0 +1,107 @@
+#include <Magnum/Trade/AbstractImageConverter.h>
+#include <Corrade/PluginManager/Manager.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/FormatStl.h>
+#include <algorithm>
+
+#include "FrameCapture.hpp"
+
+using namespace Magnum;
+
+FrameCapture::FrameCapture(std::filesystem::path directory, string extension)
+		: _directory{std::move(directory)}, _extension{std::move(extension)}
+{
+	_worker = std::thread{[this]()
+	                      { run(); }};
+}
+
+FrameCapture::~FrameCapture()
+{
+	{
+		std::lock_guard lock{_mutex};
+		_stopping = true;
+	}
+	_wake.notify_one();
+	_worker.join();
+}
+
+u32 FrameCapture::start()
+{
+	/* Numbered after the sessions already on disk, earlier runs included */
+	u32 index = 0;
+	std::error_code error;
+	while (std::filesystem::exists(_directory / Utility::formatString("session{:.4}", index), error))
+	{ ++index; }
+
+	_sessionDirectory = _directory / Utility::formatString("session{:.4}", index);
+	std::filesystem::create_directories(_sessionDirectory, error);
+	if (error)
+	{ Warning{} << "FrameCapture: could not create" << _sessionDirectory.string(); }
+
+	_sessionFrames = 0;
+	_capturing = true;
+	return ++_session;
+}
+
+bool FrameCapture::push(u32 session, Image2D&& image)
+{
+	if (session != _session)
+	{
+		++_dropped;
+		return false;
+	}
+
+	{
+		std::lock_guard lock{_mutex};
+		if (_queue.size() >= MaxQueued)
+		{
+			++_dropped;
+			return false;
+		}
+		const string file = Utility::formatString("frame{:.6}.{}", _sessionFrames++, _extension);
+		_queue.push_back({std::move(image), _sessionDirectory / file});
+	}
+	_wake.notify_one();
+	return true;
+}
+
+void FrameCapture::run()
+{
+	PluginManager::Manager<Trade::AbstractImageConverter> manager;
+	Containers::Pointer<Trade::AbstractImageConverter> converter = manager.loadAndInstantiate("StbImageConverter");
+	if (!converter)
+	{ Error{} << "FrameCapture: could not load plugin StbImageConverter, frames will be dropped"; }
+
+	for (;;)
+	{
+		std::unique_lock lock{_mutex};
+		_wake.wait(lock, [this]()
+		{ return _stopping || !_queue.empty(); });
+		if (_queue.empty())
+		{ return; }
+
+		Frame frame = std::move(_queue.front());
+		_queue.pop_front();
+		lock.unlock();
+
+		if (!converter)
+		{
+			++_dropped;
+			continue;
+		}
+
+		/* GL rows go bottom-up, image files top-down */
+		Containers::ArrayView<char> data = frame.image.data();
+		const std::size_t rows = std::size_t(frame.image.size().y()), stride = data.size() / rows;
+		for (std::size_t y = 0; y < rows / 2; ++y)
+		{
+			std::swap_ranges(data.data() + y * stride, data.data() + (y + 1) * stride,
+			                 data.data() + (rows - 1 - y) * stride);
+		}
+
+		if (converter->convertToFile(frame.image, frame.file.string()))
+		{ ++_written; }
+		else
+		{ ++_dropped; }
+	}
+}
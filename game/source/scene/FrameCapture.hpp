@@ -0,0 +1,76 @@
+#pragma once
+
+#include <condition_variable>
+#include <Magnum/Image.h>
+#include <filesystem>
+#include <thread>
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+#include "../Types.hpp"
+
+/* Writes the frames it is fed, as delivered by FrameReadback, to numbered image files on a thread of its own so
+ * encoding and disk never hold up rendering. Converter plugins aren't thread-safe and a ThreadPool worker blocked on
+ * disk would stall parallel jobs, hence the dedicated thread. It lives as long as the application: stopping a capture
+ * only stops taking frames, what is queued drains in the background. Every start() writes to a new numbered
+ * subdirectory, so sessions never overwrite each other. Frames pushed while MaxQueued are waiting get dropped. */
+class FrameCapture
+{
+public:
+	static constexpr std::size_t MaxQueued = 8;
+
+	/* The extension picks the file format among those of StbImageConverter */
+	explicit FrameCapture(std::filesystem::path directory, string extension = "png");
+
+	/* Writes what is still queued before returning */
+	~FrameCapture();
+
+	FrameCapture(FrameCapture const&) = delete;
+
+	FrameCapture& operator=(FrameCapture const&) = delete;
+
+	/* Opens the next free session subdirectory and returns the session to push frames to */
+	u32 start();
+
+	/* Frames of the session already requested still get pushed and written, it is only the caller that stops */
+	void stop()
+	{ _capturing = false; }
+
+	[[nodiscard]] bool isCapturing() const
+	{ return _capturing; }
+
+	/* Takes a bottom-up color image, false when it was dropped because the queue is full or another session has
+	 * started since it was requested */
+	bool push(u32 session, Magnum::Image2D&& image);
+
+	[[nodiscard]] u64 written() const
+	{ return _written; }
+
+	[[nodiscard]] u64 dropped() const
+	{ return _dropped; }
+
+private:
+	struct Frame
+	{
+		Magnum::Image2D image;
+		std::filesystem::path file;
+	};
+
+	std::filesystem::path _directory;
+	string _extension;
+	/* Only touched by the thread calling start() and push() */
+	std::filesystem::path _sessionDirectory{};
+	u32 _session{0};
+	u64 _sessionFrames{0};
+	bool _capturing{false};
+
+	std::deque<Frame> _queue{};
+	std::mutex _mutex{};
+	std::condition_variable _wake{};
+	bool _stopping{false};
+	std::atomic<u64> _written{0}, _dropped{0};
+	std::thread _worker{};
+
+	void run();
+};
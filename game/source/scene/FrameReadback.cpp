@@ -0,0 +1,81 @@
+#include <Magnum/GL/PixelFormat.h>
+#include <utility>
+
+#include "FrameReadback.hpp"
+
+using namespace Magnum;
+
+FrameReadback::FrameReadback(u32 slots) : _slots(slots)
+{
+	CORRADE_ASSERT(slots > 0, "FrameReadback: expected at least one slot", );
+}
+
+FrameReadback::~FrameReadback()
+{
+	for (Slot& slot: _slots)
+	{
+		if (slot.fence)
+		{ glDeleteSync(slot.fence); }
+	}
+}
+
+FrameReadback::FrameReadback(FrameReadback&& other) noexcept
+		: _slots{std::move(other._slots)}, _head{other._head}, _count{std::exchange(other._count, 0)},
+		  _dropped{other._dropped}
+{}
+
+FrameReadback& FrameReadback::operator=(FrameReadback&& other) noexcept
+{
+	std::swap(_slots, other._slots);
+	std::swap(_head, other._head);
+	std::swap(_count, other._count);
+	std::swap(_dropped, other._dropped);
+	return *this;
+}
+
+bool FrameReadback::read(GL::AbstractFramebuffer& framebuffer, i32range2 const& rect, PixelFormat format,
+                         Callback done)
+{
+	if (_count == _slots.size())
+	{
+		++_dropped;
+		return false;
+	}
+
+	/* Slots keep their buffer, reading into it again only respecifies the storage */
+	Slot& slot = _slots[(_head + _count) % _slots.size()];
+	if (!slot.image.buffer().id() || slot.format != format)
+	{
+		slot.image = GL::BufferImage2D{GL::pixelFormat(format), GL::pixelType(format)};
+		slot.format = format;
+	}
+
+	framebuffer.read(rect, slot.image, GL::BufferUsage::StreamRead);
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot.done = std::move(done);
+	++_count;
+	return true;
+}
+
+void FrameReadback::update()
+{
+	while (_count > 0)
+	{
+		/* Fences signal in order, the first one still pending holds back the newer ones. The buffer swap between
+		 * frames flushes them, polling doesn't need to. */
+		Slot& slot = _slots[_head];
+		if (glClientWaitSync(slot.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+		{ break; }
+
+		glDeleteSync(slot.fence);
+		slot.fence = nullptr;
+		Image2D image{slot.format, slot.image.size(),
+		              slot.image.buffer().subData(0, GLsizeiptr(slot.image.dataSize()))};
+		Callback done = std::move(slot.done);
+		_head = (_head + 1) % u32(_slots.size());
+		--_count;
+
+		if (done)
+		{ done(std::move(image)); }
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Magnum/GL/AbstractFramebuffer.h>
+#include <Magnum/GL/BufferImage.h>
+#include <Magnum/PixelFormat.h>
+#include <Magnum/GL/OpenGL.h>
+#include <Magnum/Image.h>
+
+#include "../Types.hpp"
+
+/* Asynchronous framebuffer reads. Each read lands in a pixel pack buffer of a ring and is followed by a fence; update()
+ * hands the pixels of every read whose fence signaled to its callback, in request order, so the copy completes frames
+ * later and never stalls the pipeline. A read asked for while the whole ring is in flight gets dropped. Images are
+ * bottom-up, as GL stores them. */
+class FrameReadback
+{
+public:
+	using Callback = function<void(Magnum::Image2D&&)>;
+
+	explicit FrameReadback(NoCreateT) noexcept
+	{}
+
+	/* slots reads may be in flight at once, the default covers a few frames of continuous capture */
+	explicit FrameReadback(u32 slots = 4);
+
+	~FrameReadback();
+
+	FrameReadback(FrameReadback const&) = delete;
+
+	FrameReadback(FrameReadback&& other) noexcept;
+
+	FrameReadback& operator=(FrameReadback const&) = delete;
+
+	FrameReadback& operator=(FrameReadback&& other) noexcept;
+
+	/* Queues a copy of rect of the framebuffer read attachment, or of its depth for a depth format. False when the
+	 * ring is full. */
+	bool read(Magnum::GL::AbstractFramebuffer& framebuffer, i32range2 const& rect, Magnum::PixelFormat format,
+	          Callback done);
+
+	/* Delivers the reads the GPU is done with, call once a frame */
+	void update();
+
+	[[nodiscard]] u32 pending() const
+	{ return _count; }
+
+	/* Reads refused because the ring was full */
+	[[nodiscard]] u64 dropped() const
+	{ return _dropped; }
+
+private:
+	struct Slot
+	{
+		Magnum::GL::BufferImage2D image{NoCreate};
+		Magnum::PixelFormat format{};
+		GLsync fence{nullptr};
+		Callback done{};
+	};
+
+	vector<Slot> _slots{};
+	u32 _head{0};
+	u32 _count{0};
+	u64 _dropped{0};
+};
@@ -0,0 +1,14 @@
+#include "Frustum.hpp"
+
+Frustum::Frustum(f32mat4 const& viewProjection)
+{
+	const f32vec4 x = viewProjection.row(0), y = viewProjection.row(1),
+			z = viewProjection.row(2), w = viewProjection.row(3);
+
+	for (f32vec4 const& plane: {w + x, w - x, w + y, w - y, z, w - z})
+	{
+		const f32 length = plane.xyz().length();
+		if (length > 1.0e-6f)
+		{ _planes[_count++] = plane / length; }
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "../Types.hpp"
+
+/* View frustum planes extracted from a view-projection matrix with a [0, 1] clip depth range. Works for the
+ * reversed-Z infinite projection from Scene::createReverseProjectionMatrix(), whose degenerate far plane is
+ * simply dropped. */
+class Frustum
+{
+	array<f32vec4, 6> _planes{};
+	u32 _count{0};
+
+public:
+	Frustum() = default;
+
+	explicit Frustum(f32mat4 const& viewProjection);
+
+	[[nodiscard]] span<f32vec4 const> planes() const
+	{ return {_planes.data(), _count}; }
+
+	[[nodiscard]] bool intersectsSphere(f32vec3 const& center, f32 radius) const
+	{
+		for (u32 i = 0; i < _count; ++i)
+		{
+			if (Magnum::Math::dot(_planes[i].xyz(), center) + _planes[i].w() < -radius)
+			{ return false; }
+		}
+		return true;
+	}
+};
@@ -0,0 +1,97 @@
+#include "GpuProfiler.hpp"
+
+using namespace Magnum;
+
+u32 GpuProfiler::pass(string const& name)
+{
+	const auto [it, inserted] = _ids.try_emplace(name, u32(_passes.size()));
+	if (inserted)
+	{ _passes.push_back(Pass{name}); }
+	return it->second;
+}
+
+GpuProfiler::Pass const* GpuProfiler::find(string const& name) const
+{
+	const auto it = _ids.find(name);
+	return it != _ids.end() ? &_passes[it->second] : nullptr;
+}
+
+void GpuProfiler::beginFrame()
+{
+	Frame& frame = _frames[_frame % Latency];
+	if (frame.recorded)
+	{ collect(frame); }
+
+	frame.markers.clear();
+	frame.used = 0;
+	frame.recorded = false;
+	_recording = _enabled;
+}
+
+void GpuProfiler::endFrame()
+{
+	_frames[_frame % Latency].recorded = _recording;
+	_recording = false;
+	++_frame;
+}
+
+u32 GpuProfiler::begin(u32 pass)
+{
+	CORRADE_ASSERT(pass < _passes.size(), "GpuProfiler::begin(): unknown pass" << pass, 0);
+	if (!_recording)
+	{ return 0; }
+
+	Frame& frame = _frames[_frame % Latency];
+	frame.markers.push_back({pass, timestamp(), ~0u});
+	return u32(frame.markers.size() - 1);
+}
+
+void GpuProfiler::end(u32 marker)
+{
+	if (!_recording)
+	{ return; }
+
+	Frame& frame = _frames[_frame % Latency];
+	CORRADE_ASSERT(marker < frame.markers.size() && frame.markers[marker].end == ~0u,
+	               "GpuProfiler::end(): marker" << marker << "isn't open", );
+	frame.markers[marker].end = timestamp();
+}
+
+u32 GpuProfiler::timestamp()
+{
+	Frame& frame = _frames[_frame % Latency];
+	if (frame.used == frame.queries.size())
+	{ frame.queries.emplace_back(GL::TimeQuery::Target::Timestamp); }
+
+	frame.queries[frame.used].timestamp();
+	return frame.used++;
+}
+
+void GpuProfiler::collect(Frame& frame)
+{
+	/* Queries complete in order, the last one being ready means they all are. Latency frames old by now, a driver that
+	 * still isn't done only costs this frame its samples. */
+	if (frame.used == 0 || !frame.queries[frame.used - 1].resultAvailable())
+	{ return; }
+
+	_totals.assign(_passes.size(), 0.0);
+	for (Marker const& marker: frame.markers)
+	{
+		/* A pass left open has no duration */
+		if (marker.end == ~0u)
+		{ continue; }
+
+		const u64 start = frame.queries[marker.begin].result<u64>();
+		const u64 stop = frame.queries[marker.end].result<u64>();
+		_totals[marker.pass] += f64(stop - start) * 1e-6;
+	}
+
+	for (std::size_t i = 0; i < _passes.size(); ++i)
+	{
+		Pass& pass = _passes[i];
+		pass.last = f32(_totals[i]);
+		pass.samples[pass.head] = pass.last;
+		pass.head = (pass.head + 1) % History;
+		pass.average = Math::lerp(pass.average, pass.last, 0.05f);
+	}
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <Magnum/GL/TimeQuery.h>
+#include <unordered_map>
+
+#include "../Types.hpp"
+
+/* GPU time of named passes. Every pass is bracketed by two timestamp queries, which unlike time elapsed ones may nest
+ * and overlap DynamicResolution's; the results are read back Latency frames later so profiling never stalls. A pass
+ * entered several times in a frame adds up, and each keeps the last History per-frame samples in milliseconds. */
+class GpuProfiler
+{
+public:
+	static constexpr u32 Latency = 4;
+	static constexpr u32 History = 240;
+
+	struct Pass
+	{
+		string name;
+		/* Ring of per-frame milliseconds, head is the oldest sample */
+		array<f32, History> samples{};
+		u32 head{0};
+		f32 last{0.f};
+		f32 average{0.f};
+	};
+
+	/* Times a pass for as long as it lives */
+	class Scope
+	{
+	public:
+		Scope(GpuProfiler& profiler, u32 pass) : _profiler{profiler}, _marker{profiler.begin(pass)}
+		{}
+
+		Scope(Scope const&) = delete;
+
+		Scope& operator=(Scope const&) = delete;
+
+		~Scope()
+		{ _profiler.end(_marker); }
+
+	private:
+		GpuProfiler& _profiler;
+		u32 _marker;
+	};
+
+	explicit GpuProfiler(NoCreateT) noexcept
+	{}
+
+	GpuProfiler() = default;
+
+	GpuProfiler(GpuProfiler const&) = delete;
+
+	GpuProfiler(GpuProfiler&&) noexcept = default;
+
+	GpuProfiler& operator=(GpuProfiler const&) = delete;
+
+	GpuProfiler& operator=(GpuProfiler&&) noexcept = default;
+
+	void setEnabled(bool enabled)
+	{ _enabled = enabled; }
+
+	[[nodiscard]] bool isEnabled() const
+	{ return _enabled; }
+
+	/* Id of the pass called name, registering it on first use; callers in hot paths keep the id */
+	u32 pass(string const& name);
+
+	/* Reads back the frame issued Latency frames ago, then starts recording this one */
+	void beginFrame();
+
+	void endFrame();
+
+	/* Returns the marker to end the pass with */
+	u32 begin(u32 pass);
+
+	void end(u32 marker);
+
+	Scope scope(u32 pass)
+	{ return Scope{*this, pass}; }
+
+	Scope scope(string const& name)
+	{ return Scope{*this, pass(name)}; }
+
+	[[nodiscard]] span<Pass const> passes() const
+	{ return {_passes.data(), _passes.size()}; }
+
+	/* Pass registered under name, nullptr if there is none */
+	[[nodiscard]] Pass const* find(string const& name) const;
+
+private:
+	struct Marker
+	{
+		u32 pass;
+		u32 begin;
+		/* Query index of the end, ~0u while the pass is open */
+		u32 end;
+	};
+
+	/* Queries only ever grow, a slot reuses the ones of the frame it recorded Latency frames before */
+	struct Frame
+	{
+		vector<Magnum::GL::TimeQuery> queries{};
+		vector<Marker> markers{};
+		u32 used{0};
+		bool recorded{false};
+	};
+
+	array<Frame, Latency> _frames{};
+	vector<Pass> _passes{};
+	std::unordered_map<string, u32> _ids{};
+	vector<f64> _totals{};
+	u32 _frame{0};
+	bool _enabled{true};
+	bool _recording{false};
+
+	u32 timestamp();
+
+	void collect(Frame& frame);
+};
@@ -0,0 +1,138 @@
+#include <Corrade/Containers/ArrayView.h>
+#include <cmath>
+
+#include "LightClusters.hpp"
+
+using namespace Magnum;
+
+LightClusters::LightClusters()
+		: _lightBuffer{GL::Buffer::TargetHint::ShaderStorage},
+		  _clusterBuffer{GL::Buffer::TargetHint::ShaderStorage},
+		  _indexBuffer{GL::Buffer::TargetHint::ShaderStorage}
+{
+	setDepthRange(_near, _far);
+}
+
+void LightClusters::setDepthRange(f32 near, f32 far)
+{
+	CORRADE_ASSERT(near > 0.f && far > near, "LightClusters::setDepthRange(): invalid range" << near << far, );
+	_near = near;
+	_far = far;
+	_sliceScale = f32(Size.z()) / std::log(_far / _near);
+}
+
+u32 LightClusters::slice(f32 depth) const
+{
+	if (!(depth > _near))
+	{ return 0; }
+	return u32(Math::min(std::log(depth / _near) * _sliceScale, f32(Size.z() - 1)));
+}
+
+optional<std::pair<u32vec3, u32vec3>> LightClusters::bounds(f32vec3 const& center, f32 radius,
+                                                             f32mat4 const& projection) const
+{
+	/* View space looks down -Z */
+	const f32 closest = -center.z() - radius, farthest = -center.z() + radius;
+	if (farthest < _near)
+	{ return nullopt; }
+
+	u32vec3 min{0, 0, slice(closest)}, max{Size.x() - 1, Size.y() - 1, slice(farthest)};
+
+	/* Spheres crossing the near plane cover the whole screen, the others are bounded by their projected box */
+	if (closest > _near)
+	{
+		f32vec2 ndcMin{f32const::inf()}, ndcMax{-f32const::inf()};
+		for (u32 corner = 0; corner < 8; ++corner)
+		{
+			const f32vec3 point = center + f32vec3{corner & 1 ? radius : -radius,
+			                                       corner & 2 ? radius : -radius,
+			                                       corner & 4 ? radius : -radius};
+			const f32vec4 clip = projection * f32vec4{point, 1.f};
+			const f32vec2 ndc = clip.xy() / clip.w();
+			ndcMin = Math::min(ndcMin, ndc);
+			ndcMax = Math::max(ndcMax, ndc);
+		}
+
+		if ((ndcMax < f32vec2{-1.f}).any() || (ndcMin > f32vec2{1.f}).any())
+		{ return nullopt; }
+
+		const f32vec2 tiles{Size.xy()};
+		const f32vec2 first = Math::clamp((ndcMin * .5f + f32vec2{.5f}) * tiles, f32vec2{0.f}, tiles - f32vec2{1.f});
+		const f32vec2 last = Math::clamp((ndcMax * .5f + f32vec2{.5f}) * tiles, f32vec2{0.f}, tiles - f32vec2{1.f});
+		min = {u32(first.x()), u32(first.y()), min.z()};
+		max = {u32(last.x()), u32(last.y()), max.z()};
+	}
+
+	return std::make_pair(min, max);
+}
+
+void LightClusters::build(span<Light const> lights, f32mat4 const& view, f32mat4 const& projection)
+{
+	const u32 clusterCount = Size.product();
+	auto index = [](u32 x, u32 y, u32 z)
+	{ return (z * Size.y() + y) * Size.x() + x; };
+
+	_lights.assign(lights.begin(), lights.end());
+	_bounds.assign(lights.size(), {u32vec3{1}, u32vec3{0}});
+	_clusters.assign(clusterCount, u32vec2{0});
+
+	/* Count the lights of every cluster, turn the counts into offsets, then scatter the indices */
+	for (std::size_t i = 0; i < lights.size(); ++i)
+	{
+		const f32vec3 center = view.transformPoint(lights[i].position.xyz());
+		if (auto range = bounds(center, lights[i].position.w(), projection))
+		{ _bounds[i] = *range; }
+
+		auto const& [min, max] = _bounds[i];
+		for (u32 z = min.z(); z <= max.z(); ++z)
+		{
+			for (u32 y = min.y(); y <= max.y(); ++y)
+			{
+				for (u32 x = min.x(); x <= max.x(); ++x)
+				{ ++_clusters[index(x, y, z)].y(); }
+			}
+		}
+	}
+
+	u32 offset = 0;
+	for (u32vec2& cluster: _clusters)
+	{
+		cluster.x() = offset;
+		offset += cluster.y();
+		cluster.y() = 0;
+	}
+
+	_indices.resize(offset);
+	for (std::size_t i = 0; i < lights.size(); ++i)
+	{
+		auto const& [min, max] = _bounds[i];
+		for (u32 z = min.z(); z <= max.z(); ++z)
+		{
+			for (u32 y = min.y(); y <= max.y(); ++y)
+			{
+				for (u32 x = min.x(); x <= max.x(); ++x)
+				{
+					u32vec2& cluster = _clusters[index(x, y, z)];
+					_indices[cluster.x() + cluster.y()++] = u32(i);
+				}
+			}
+		}
+	}
+}
+
+void LightClusters::upload(u32 lightBinding, u32 clusterBinding, u32 indexBinding)
+{
+	/* Empty storage buffers cannot be bound, keep a dummy element around */
+	if (_lights.empty())
+	{ _lights.emplace_back(); }
+	if (_indices.empty())
+	{ _indices.push_back(0); }
+
+	_lightBuffer.setData(Containers::arrayView(_lights.data(), _lights.size()), GL::BufferUsage::StreamDraw);
+	_clusterBuffer.setData(Containers::arrayView(_clusters.data(), _clusters.size()), GL::BufferUsage::StreamDraw);
+	_indexBuffer.setData(Containers::arrayView(_indices.data(), _indices.size()), GL::BufferUsage::StreamDraw);
+
+	_lightBuffer.bind(GL::Buffer::Target::ShaderStorage, lightBinding);
+	_clusterBuffer.bind(GL::Buffer::Target::ShaderStorage, clusterBinding);
+	_indexBuffer.bind(GL::Buffer::Target::ShaderStorage, indexBinding);
+}
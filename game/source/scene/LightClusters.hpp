@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Magnum/GL/Buffer.h>
+
+#include "../Types.hpp"
+
+/* Bins lights into a froxel grid over the view frustum: Size.x() by Size.y() screen tiles and Size.z() depth slices,
+ * exponentially spaced between the near and far depth. Depths past the far one fall into the last slice. Each
+ * cluster stores an (offset, count) range into a flat light index list, so a fragment only shades the lights whose
+ * range reaches its cluster. Lights and both lists live in shader storage buffers. */
+class LightClusters
+{
+public:
+	/* std430 layout shared with pbr.uniforms.glsl */
+	struct Light
+	{
+		/* w is the range, infinite lights reach every cluster */
+		f32vec4 position{};
+		f32vec4 color{};
+	};
+
+	static constexpr u32vec3 Size{16, 9, 24};
+
+	explicit LightClusters(NoCreateT) noexcept
+	{}
+
+	LightClusters();
+
+	void setDepthRange(f32 near, f32 far);
+
+	[[nodiscard]] f32 nearDepth() const
+	{ return _near; }
+
+	/* Depth slices per unit of log(depth / nearDepth()) */
+	[[nodiscard]] f32 sliceScale() const
+	{ return _sliceScale; }
+
+	/* lights are in the same space as view, projection is used to bound them on screen */
+	void build(span<Light const> lights, f32mat4 const& view, f32mat4 const& projection);
+
+	/* Uploads the last build() and binds the buffers to their shader storage bindings */
+	void upload(u32 lightBinding, u32 clusterBinding, u32 indexBinding);
+
+	[[nodiscard]] span<u32vec2 const> clusters() const
+	{ return _clusters; }
+
+	[[nodiscard]] span<u32 const> indices() const
+	{ return _indices; }
+
+private:
+	f32 _near{0.1f}, _far{10'000.f}, _sliceScale{0.f};
+
+	vector<Light> _lights{};
+	vector<std::pair<u32vec3, u32vec3>> _bounds{};
+	vector<u32vec2> _clusters{};
+	vector<u32> _indices{};
+
+	Magnum::GL::Buffer _lightBuffer{NoCreate}, _clusterBuffer{NoCreate}, _indexBuffer{NoCreate};
+
+	[[nodiscard]] u32 slice(f32 depth) const;
+
+	/* Inclusive cluster range touched by a view space sphere, nullopt when it is off-screen */
+	[[nodiscard]] optional<std::pair<u32vec3, u32vec3>> bounds(f32vec3 const& center, f32 radius,
+	                                                           f32mat4 const& projection) const;
+};
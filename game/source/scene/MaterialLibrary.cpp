@@ -0,0 +1,106 @@
+#include <Corrade/PluginManager/Manager.h>
+#include <Magnum/Trade/AbstractImporter.h>
+#include <Magnum/GL/TextureFormat.h>
+#include <Magnum/Trade/ImageData.h>
+#include <Magnum/PixelFormat.h>
+#include <Magnum/ImageView.h>
+
+#include "MaterialLibrary.hpp"
+
+using namespace Magnum;
+
+namespace
+{
+	constexpr array<char const*, MaterialLibrary::MapCount> MapFiles{
+			"albedo.png", "normal.png", "metallic.png", "roughness.png", "ao.png", "emissive.png"};
+
+	/* Uploads convert whatever the file holds to these */
+	constexpr array<GL::TextureFormat, MaterialLibrary::MapCount> MapFormats{
+			GL::TextureFormat::RGBA8, GL::TextureFormat::RGBA8, GL::TextureFormat::R8, GL::TextureFormat::R8,
+			GL::TextureFormat::R8, GL::TextureFormat::RGBA8};
+}
+
+PhysicalMaterial const& MaterialLibrary::load(std::filesystem::path const& directory, f32 emissivePower)
+{
+	const string key = directory.lexically_normal().string();
+	if (const auto it = _materials.find(key); it != _materials.end())
+	{ return it->second; }
+
+	PluginManager::Manager<Trade::AbstractImporter> manager;
+	Containers::Pointer<Trade::AbstractImporter> importer = manager.loadAndInstantiate("StbImageImporter");
+	if (!importer)
+	{
+		Fatal{} << "Could not load plugin StbImageImporter";
+		std::exit(1);
+	}
+
+	vector<Trade::ImageData2D> images;
+	const bool emissive = std::filesystem::exists(directory / MapFiles[u32(Map::Emissive)]);
+	for (char const* file: MapFiles)
+	{
+		const std::filesystem::path filename = directory / file;
+		if (images.size() == u32(Map::Emissive) && !emissive)
+		{
+			/* Uploaded black rather than skipped, texture storage is undefined until written */
+			const i32vec2 size = images.front().size();
+			images.emplace_back(PixelFormat::RGBA8Unorm, size,
+			                    Containers::Array<char>{ValueInit, std::size_t(size.product()) * 4});
+			continue;
+		}
+
+		Containers::Optional<Trade::ImageData2D> image;
+		if (!importer->openFile(filename.string().c_str()) || !(image = importer->image2D(0)))
+		{
+			Fatal{} << "Could not load texture" << filename.string();
+			std::exit(1);
+		}
+		if (!images.empty() && image->size() != images.front().size())
+		{
+			Fatal{} << "MaterialLibrary: maps of" << key << "differ in size," << file << "is" << image->size()
+			        << "while" << MapFiles[0] << "is" << images.front().size();
+			std::exit(1);
+		}
+		images.push_back(std::move(*image));
+	}
+
+	PhysicalMaterial material{};
+	material.emissivePower = emissive ? emissivePower : 0.f;
+	material.page = pageFor(images.front().size());
+	Page& page = _pages[material.page];
+	material.layer = page.layers++;
+
+	for (u32 map = 0; map < MapCount; ++map)
+	{
+		Trade::ImageData2D const& image = images[map];
+		page.maps[map].setSubImage(0, {0, 0, i32(material.layer)},
+		                           ImageView3D{image.storage(), image.format(), {image.size(), 1}, image.data()});
+	}
+
+	return _materials.emplace(key, material).first->second;
+}
+
+void MaterialLibrary::bind(u32 page)
+{
+	CORRADE_ASSERT(page < _pages.size(), "MaterialLibrary::bind(): no page" << page, );
+	array<GL::Texture2DArray, MapCount>& maps = _pages[page].maps;
+	GL::AbstractTexture::bind(0, {&maps[0], &maps[1], &maps[2], &maps[3], &maps[4], &maps[5]});
+}
+
+u32 MaterialLibrary::pageFor(i32vec2 const& size)
+{
+	for (u32 i = 0; i < _pages.size(); ++i)
+	{
+		if (_pages[i].size == size && _pages[i].layers < PageLayers)
+		{ return i; }
+	}
+
+	Page& page = _pages.emplace_back(Page{size, 0, {}});
+	for (u32 map = 0; map < MapCount; ++map)
+	{
+		page.maps[map].setWrapping(GL::SamplerWrapping::ClampToEdge)
+		              .setMagnificationFilter(GL::SamplerFilter::Linear)
+		              .setMinificationFilter(GL::SamplerFilter::Linear)
+		              .setStorage(1, MapFormats[map], {size, i32(PageLayers)});
+	}
+	return u32(_pages.size() - 1);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Magnum/GL/TextureArray.h>
+#include <unordered_map>
+#include <filesystem>
+
+#include "../Types.hpp"
+
+/* Where the textures of a material live in a MaterialLibrary */
+struct PhysicalMaterial
+{
+	u32 page;
+	u32 layer;
+	/* Scales the emissive map, 0 for materials without one */
+	f32 emissivePower;
+};
+
+/* PBR material textures packed into texture arrays. Materials whose maps share a size go to the same page, a set of
+ * one Texture2DArray per map with PageLayers layers; a draw binds its page and picks its layer through
+ * PhysicalShader::DrawUniform::material, so switching between materials of a page binds nothing. Pages are only
+ * ever appended, a full one is followed by a new page of the same size. ARB_bindless_texture handles would lift the
+ * same-size constraint, but arrays are core and cover every material so far. */
+class MaterialLibrary
+{
+public:
+	static constexpr u32 PageLayers = 16;
+
+	/* Order of the maps in a page, also the texture units pbr.frag.glsl samples them from */
+	enum class Map : u8
+	{
+		Albedo,
+		Normal,
+		Metallic,
+		Roughness,
+		AmbientOcclusion,
+		/* Optional, black when the material has none */
+		Emissive
+	};
+
+	static constexpr u32 MapCount = 6;
+
+	MaterialLibrary() = default;
+
+	MaterialLibrary(MaterialLibrary const&) = delete;
+
+	MaterialLibrary(MaterialLibrary&&) noexcept = default;
+
+	MaterialLibrary& operator=(MaterialLibrary const&) = delete;
+
+	MaterialLibrary& operator=(MaterialLibrary&&) noexcept = default;
+
+	/* Loads albedo.png, normal.png, metallic.png, roughness.png, ao.png and, when there is one, emissive.png of
+	 * directory, once per directory; the first load decides the emissive power. The maps must all have the same size.
+	 * The reference stays valid for the lifetime of the library. */
+	PhysicalMaterial const& load(std::filesystem::path const& directory, f32 emissivePower = 1.f);
+
+	/* Binds the arrays of page to the texture units of their Map */
+	void bind(u32 page);
+
+	[[nodiscard]] std::size_t size() const
+	{ return _materials.size(); }
+
+	[[nodiscard]] std::size_t pageCount() const
+	{ return _pages.size(); }
+
+private:
+	struct Page
+	{
+		i32vec2 size;
+		u32 layers;
+		array<Magnum::GL::Texture2DArray, MapCount> maps;
+	};
+
+	std::unordered_map<string, PhysicalMaterial> _materials{};
+	vector<Page> _pages{};
+
+	u32 pageFor(i32vec2 const& size);
+};
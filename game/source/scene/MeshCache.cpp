@@ -0,0 +1,106 @@
+#include <Magnum/Trade/AbstractImporter.h>
+#include <Corrade/PluginManager/Manager.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Utility/FormatStl.h>
+#include <Magnum/MeshTools/Compile.h>
+#include <Magnum/Primitives/Cube.h>
+#include <Magnum/Trade/MeshData.h>
+#include <algorithm>
+
+#include "MeshCache.hpp"
+
+using namespace Magnum;
+
+MeshComponent MeshCache::uvSphereSolid(u32 rings, u32 segments, Primitives::UVSphereFlags flags)
+{
+	return get(Utility::formatString("uvSphereSolid:{}:{}:{}", rings, segments,
+	                                 u32(Primitives::UVSphereFlags::UnderlyingType(flags))),
+	           [rings, segments, flags]()
+	           { return Primitives::uvSphereSolid(rings, segments, flags); },
+	           [rings, segments, flags](Trade::MeshData const&)
+	           {
+		           vector<MeshSimplifier::Level> ret;
+		           for (u32 r = rings / 2, s = segments / 2; r >= 4 && s >= 6; r /= 2, s /= 2)
+		           {
+			           /* Largest angle spanned by an edge, the chord then sags by 1 - cos(angle / 2) */
+			           const f32 angle = Math::max(f32const::pi() / f32(r), 2.f * f32const::pi() / f32(s));
+			           ret.push_back({Primitives::uvSphereSolid(r, s, flags), 1.f - Math::cos(f32rad{angle / 2.f})});
+		           }
+		           return ret;
+	           });
+}
+
+MeshComponent MeshCache::planeSolid(Primitives::PlaneFlags flags)
+{
+	return get(Utility::formatString("planeSolid:{}", u32(Primitives::PlaneFlags::UnderlyingType(flags))),
+	           [flags]()
+	           { return Primitives::planeSolid(flags); });
+}
+
+MeshComponent MeshCache::cubeSolid()
+{
+	return get("cubeSolid", []()
+	{ return Primitives::cubeSolid(); });
+}
+
+MeshComponent MeshCache::file(std::filesystem::path const& path)
+{
+	return get("file:" + path.string(), [&path]()
+	{
+		PluginManager::Manager<Trade::AbstractImporter> manager;
+		Containers::Pointer<Trade::AbstractImporter> importer = manager.loadAndInstantiate("AnySceneImporter");
+		if (!importer || !importer->openFile(path.string().c_str()) || importer->meshCount() == 0)
+		{
+			Fatal{} << "Could not load mesh" << path.string();
+			std::exit(1);
+		}
+
+		Containers::Optional<Trade::MeshData> data = importer->mesh(0);
+		CORRADE_INTERNAL_ASSERT(data);
+		return std::move(*data);
+	}, [](Trade::MeshData const& data)
+	{ return MeshSimplifier::levels(data); });
+}
+
+MeshComponent MeshCache::get(string const& key, function<Trade::MeshData()> const& build, LodBuilder const& lods)
+{
+	if (auto it = _entries.find(key); it != _entries.end())
+	{
+		Entry const& entry = it->second;
+		std::shared_ptr<GpuMesh> gpu = entry.gpu.lock();
+		vector<MeshLod> levels;
+		for (WeakLod const& lod: entry.lods)
+		{
+			if (std::shared_ptr<GpuMesh> level = lod.gpu.lock())
+			{ levels.push_back({std::move(level), lod.error}); }
+		}
+		if (gpu && levels.size() == entry.lods.size())
+		{ return MeshComponent{std::move(gpu), entry.center, entry.radius, std::move(levels)}; }
+	}
+
+	const Trade::MeshData data = build();
+	MeshComponent ret{data};
+	Entry entry{ret.gpu, {}, ret.center, ret.radius};
+	if (lods)
+	{
+		for (MeshSimplifier::Level const& level: lods(data))
+		{
+			ret.lods.push_back({std::make_shared<GpuMesh>(GpuMesh{MeshTools::compile(level.mesh)}), level.error});
+			entry.lods.push_back({ret.lods.back().gpu, level.error});
+		}
+	}
+	_entries.insert_or_assign(key, std::move(entry));
+	return ret;
+}
+
+std::size_t MeshCache::size() const
+{
+	return std::size_t(std::count_if(_entries.begin(), _entries.end(), [](auto const& entry)
+	{ return !entry.second.gpu.expired(); }));
+}
+
+void MeshCache::collect()
+{
+	std::erase_if(_entries, [](auto const& entry)
+	{ return entry.second.gpu.expired(); });
+}
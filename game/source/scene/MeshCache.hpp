@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Magnum/Primitives/UVSphere.h>
+#include <Magnum/Primitives/Plane.h>
+#include <unordered_map>
+#include <filesystem>
+
+#include "MeshSimplifier.hpp"
+#include "Components.hpp"
+#include "../Types.hpp"
+
+/* Hands out GPU meshes shared by every MeshComponent built from the same procedural primitive parameters or asset
+ * file, along with their levels of detail. Entries only hold weak references, so a mesh is released with the last
+ * component using it. */
+class MeshCache
+{
+	struct WeakLod
+	{
+		std::weak_ptr<GpuMesh> gpu;
+		f32 error;
+	};
+
+	struct Entry
+	{
+		std::weak_ptr<GpuMesh> gpu;
+		vector<WeakLod> lods;
+		f32vec3 center;
+		f32 radius;
+	};
+
+	std::unordered_map<string, Entry> _entries{};
+
+public:
+	/* Levels of detail of a mesh, built from its full detail data */
+	using LodBuilder = function<vector<MeshSimplifier::Level>(Magnum::Trade::MeshData const&)>;
+
+	MeshCache() = default;
+
+	/* Levels halve rings and segments, their error is the sagitta of the coarser tessellation */
+	MeshComponent uvSphereSolid(u32 rings, u32 segments, Magnum::Primitives::UVSphereFlags flags = {});
+
+	MeshComponent planeSolid(Magnum::Primitives::PlaneFlags flags = {});
+
+	MeshComponent cubeSolid();
+
+	/* First mesh of a file opened with AnySceneImporter, levels of detail come from MeshSimplifier */
+	MeshComponent file(std::filesystem::path const& path);
+
+	/* Returns the mesh cached under key, or caches the one build() returns with the levels lods() makes of it */
+	MeshComponent get(string const& key, function<Magnum::Trade::MeshData()> const& build,
+	                  LodBuilder const& lods = {});
+
+	/* Meshes currently alive */
+	[[nodiscard]] std::size_t size() const;
+
+	/* Forgets the entries whose mesh was released */
+	void collect();
+};
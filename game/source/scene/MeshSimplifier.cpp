@@ -0,0 +1,163 @@
+#include <Magnum/MeshTools/GenerateIndices.h>
+#include <Corrade/Containers/StridedArrayView.h>
+#include <Corrade/Containers/ArrayView.h>
+#include <unordered_map>
+#include <numeric>
+
+#include "MeshSimplifier.hpp"
+
+using namespace Magnum;
+
+namespace
+{
+	struct Vertex
+	{
+		f32vec3 position;
+		f32vec3 normal;
+		f32vec2 textureCoordinates;
+	};
+
+	struct Cluster
+	{
+		Vertex sum{};
+		u32 count{0};
+	};
+
+	/* Every input as indexed triangles, non-indexed strips and fans get converted. Empty for lines, points and
+	 * indexed strips or fans, which generateIndices() can't turn into triangles. */
+	Containers::Array<u32> triangleIndices(Trade::MeshData const& mesh)
+	{
+		if (mesh.primitive() == MeshPrimitive::Triangles)
+		{
+			if (mesh.isIndexed())
+			{ return mesh.indicesAsArray(); }
+
+			Containers::Array<u32> ret{NoInit, mesh.vertexCount()};
+			std::iota(ret.begin(), ret.end(), 0u);
+			return ret;
+		}
+
+		if (mesh.isIndexed() ||
+		    (mesh.primitive() != MeshPrimitive::TriangleStrip && mesh.primitive() != MeshPrimitive::TriangleFan))
+		{ return {}; }
+
+		const Trade::MeshData triangles = MeshTools::generateIndices(mesh);
+		if (triangles.primitive() != MeshPrimitive::Triangles)
+		{ return {}; }
+		return triangles.indicesAsArray();
+	}
+}
+
+Trade::MeshData MeshSimplifier::cluster(Trade::MeshData const& mesh, f32 cellSize)
+{
+	CORRADE_INTERNAL_ASSERT(cellSize > 0.f);
+
+	const bool hasNormals = mesh.hasAttribute(Trade::MeshAttribute::Normal);
+	const bool hasTextureCoordinates = mesh.hasAttribute(Trade::MeshAttribute::TextureCoordinates);
+	const Containers::Array<u32> indices = triangleIndices(mesh);
+	const Containers::Array<f32vec3> positions = mesh.positions3DAsArray();
+	const Containers::Array<f32vec3> normals = hasNormals ? mesh.normalsAsArray() : Containers::Array<f32vec3>{};
+	const Containers::Array<f32vec2> textureCoordinates = hasTextureCoordinates
+	                                                      ? mesh.textureCoordinates2DAsArray()
+	                                                      : Containers::Array<f32vec2>{};
+
+	f32vec3 min{f32const::inf()};
+	for (f32vec3 const& position: positions)
+	{ min = Math::min(min, position); }
+
+	/* 21 bits per axis, more cells than any sane cell size asks for */
+	std::unordered_map<u64, u32> cellClusters;
+	vector<Cluster> clusters;
+	vector<u32> remap(positions.size());
+	for (std::size_t i = 0; i < positions.size(); ++i)
+	{
+		const u32vec3 cell{Math::min((positions[i] - min) / cellSize, f32vec3{f32((1 << 21) - 1)})};
+		const u64 key = u64(cell.x()) | u64(cell.y()) << 21 | u64(cell.z()) << 42;
+
+		auto [it, inserted] = cellClusters.try_emplace(key, u32(clusters.size()));
+		if (inserted)
+		{ clusters.emplace_back(); }
+
+		Cluster& cluster = clusters[it->second];
+		cluster.sum.position += positions[i];
+		if (hasNormals)
+		{ cluster.sum.normal += normals[i]; }
+		if (hasTextureCoordinates)
+		{ cluster.sum.textureCoordinates += textureCoordinates[i]; }
+		++cluster.count;
+		remap[i] = it->second;
+	}
+
+	vector<u32> kept;
+	kept.reserve(indices.size());
+	for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		const u32 a = remap[indices[i]], b = remap[indices[i + 1]], c = remap[indices[i + 2]];
+		if (a == b || b == c || c == a)
+		{ continue; }
+		kept.insert(kept.end(), {a, b, c});
+	}
+
+	Containers::Array<char> vertexData{ValueInit, clusters.size() * sizeof(Vertex)};
+	Containers::ArrayView<Vertex> vertices = Containers::arrayCast<Vertex>(vertexData);
+	for (std::size_t i = 0; i < clusters.size(); ++i)
+	{
+		const f32 weight = 1.f / f32(clusters[i].count);
+		vertices[i].position = clusters[i].sum.position * weight;
+		vertices[i].normal = clusters[i].sum.normal.isZero() ? f32vec3{} : clusters[i].sum.normal.normalized();
+		vertices[i].textureCoordinates = clusters[i].sum.textureCoordinates * weight;
+	}
+
+	Containers::Array<char> indexData{ValueInit, kept.size() * sizeof(u32)};
+	Containers::ArrayView<u32> outIndices = Containers::arrayCast<u32>(indexData);
+	std::copy(kept.begin(), kept.end(), outIndices.begin());
+
+	const Containers::StridedArrayView1D<Vertex> view = vertices;
+	Containers::Array<Trade::MeshAttributeData> attributes{ValueInit, 1 + hasNormals + hasTextureCoordinates};
+	std::size_t attribute = 0;
+	attributes[attribute++] = Trade::MeshAttributeData{Trade::MeshAttribute::Position, view.slice(&Vertex::position)};
+	if (hasNormals)
+	{ attributes[attribute++] = Trade::MeshAttributeData{Trade::MeshAttribute::Normal, view.slice(&Vertex::normal)}; }
+	if (hasTextureCoordinates)
+	{
+		attributes[attribute++] = Trade::MeshAttributeData{Trade::MeshAttribute::TextureCoordinates,
+		                                                   view.slice(&Vertex::textureCoordinates)};
+	}
+
+	return Trade::MeshData{MeshPrimitive::Triangles, std::move(indexData), Trade::MeshIndexData{outIndices},
+	                       std::move(vertexData), std::move(attributes)};
+}
+
+vector<MeshSimplifier::Level> MeshSimplifier::levels(Trade::MeshData const& mesh, u32 maxLevels)
+{
+	vector<Level> ret;
+	const Containers::Array<f32vec3> positions = mesh.positions3DAsArray();
+	if (positions.isEmpty())
+	{ return ret; }
+
+	f32range3 box{positions[0], positions[0]};
+	for (f32vec3 const& position: positions)
+	{ box = Math::join(box, f32range3{position, position}); }
+	const f32 size = box.size().max();
+	if (size <= 0.f)
+	{ return ret; }
+
+	std::size_t triangles = triangleIndices(mesh).size() / 3;
+	if (triangles == 0)
+	{ return ret; }
+	for (u32 cells = 32; cells >= 4 && ret.size() < maxLevels; cells /= 2)
+	{
+		const f32 cellSize = size / f32(cells);
+		Trade::MeshData level = cluster(mesh, cellSize);
+		const std::size_t levelTriangles = level.indexCount() / 3;
+		if (levelTriangles == 0)
+		{ break; }
+		if (4 * levelTriangles > 3 * triangles)
+		{ continue; }
+
+		triangles = levelTriangles;
+		/* A vertex never leaves its cell */
+		ret.push_back({std::move(level), cellSize * f32const::sqrt3()});
+	}
+	return ret;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <Magnum/Trade/MeshData.h>
+
+#include "../Types.hpp"
+
+/* Level of detail generation by vertex clustering. Vertices are snapped to a uniform grid, every occupied cell
+ * collapses into the average of its vertices and triangles left with less than three distinct corners are dropped.
+ * Crude next to edge collapse, but fast enough to run at load time and the error is bounded by the cell size. */
+namespace MeshSimplifier
+{
+	struct Level
+	{
+		Magnum::Trade::MeshData mesh;
+		/* Largest distance a vertex moved, in mesh units */
+		f32 error;
+	};
+
+	/* Indexed triangles with positions, and the normals and texture coordinates the input had */
+	Magnum::Trade::MeshData cluster(Magnum::Trade::MeshData const& mesh, f32 cellSize);
+
+	/* Up to maxLevels levels with cells from 1/32 up to 1/4 of the bounding box size. A cell size that fails to remove
+	 * a quarter of the triangles of the previous level is skipped, clustering stops once nothing is left. None for
+ * meshes without triangles, like line or point primitives. */
+	vector<Level> levels(Magnum::Trade::MeshData const& mesh, u32 maxLevels = 4);
+}
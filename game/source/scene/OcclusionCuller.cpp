@@ -0,0 +1,282 @@
+#include <Corrade/Utility/Assert.h>
+#include <algorithm>
+#include <cmath>
+
+#include "OcclusionCuller.hpp"
+#include "Components.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ASTEROPE_OCCLUSION_SSE
+#include <emmintrin.h>
+#endif
+
+using namespace Magnum;
+
+namespace
+{
+	/* Winds the triangle counter-clockwise seen from outside, for shapes convex around their origin */
+	void pushOutward(vector<f32vec3>& out, f32vec3 const& a, f32vec3 const& b, f32vec3 const& c)
+	{
+		if (Math::dot(Math::cross(b - a, c - a), a + b + c) < 0.f)
+		{ out.insert(out.end(), {a, c, b}); }
+		else
+		{ out.insert(out.end(), {a, b, c}); }
+	}
+}
+
+OccluderComponent::OccluderComponent(vector<f32vec3> Triangles) : triangles{std::move(Triangles)}, radius{0.f}
+{
+	CORRADE_ASSERT(triangles.size() % 3 == 0, "OccluderComponent: vertex count" << triangles.size()
+	                                          << "is not a multiple of 3", );
+	for (f32vec3 const& vertex: triangles)
+	{ radius = Math::max(radius, vertex.length()); }
+}
+
+OccluderComponent OccluderComponent::sphere(f32 radius, u32 rings)
+{
+	const u32 segments = 2 * rings;
+	auto point = [radius, rings, segments](u32 ring, u32 segment)
+	{
+		const f32rad theta{Constants::pi() * f32(ring) / f32(rings)};
+		const f32rad phi{2.f * Constants::pi() * f32(segment) / f32(segments)};
+		return radius * f32vec3{Math::sin(theta) * Math::cos(phi), Math::cos(theta), Math::sin(theta) * Math::sin(phi)};
+	};
+
+	vector<f32vec3> triangles;
+	for (u32 i = 0; i < rings; ++i)
+	{
+		for (u32 j = 0; j < segments; ++j)
+		{
+			const f32vec3 a = point(i, j), b = point(i + 1, j), c = point(i + 1, j + 1), d = point(i, j + 1);
+			/* The triangles touching a pole collapse to a line there */
+			if (i + 1 < rings)
+			{ pushOutward(triangles, a, b, c); }
+			if (i > 0)
+			{ pushOutward(triangles, a, c, d); }
+		}
+	}
+	return OccluderComponent{std::move(triangles)};
+}
+
+OccluderComponent OccluderComponent::box(f32vec3 const& halfExtents)
+{
+	auto corner = [&halfExtents](u32 i)
+	{
+		return f32vec3{i & 1 ? halfExtents.x() : -halfExtents.x(), i & 2 ? halfExtents.y() : -halfExtents.y(),
+		               i & 4 ? halfExtents.z() : -halfExtents.z()};
+	};
+
+	vector<f32vec3> triangles;
+	/* Corners of each face in order around it, by the bits of their index */
+	constexpr u32 faces[6][4]{{0, 1, 3, 2}, {4, 5, 7, 6}, {0, 1, 5, 4}, {2, 3, 7, 6}, {0, 2, 6, 4}, {1, 3, 7, 5}};
+	for (auto const& face: faces)
+	{
+		pushOutward(triangles, corner(face[0]), corner(face[1]), corner(face[2]));
+		pushOutward(triangles, corner(face[0]), corner(face[2]), corner(face[3]));
+	}
+	return OccluderComponent{std::move(triangles)};
+}
+
+OcclusionCuller::OcclusionCuller() : _depth(std::size_t(Width * Height), 0.f), _tiles(std::size_t(TilesX * TilesY), 0.f)
+{}
+
+void OcclusionCuller::render(f32mat4 const& viewProjection, Frustum const& frustum, span<Occluder const> occluders,
+                             ThreadPool* pool)
+{
+	_viewProjection = viewProjection;
+	_triangles.clear();
+
+	for (Occluder const& occluder: occluders)
+	{
+		/* Rigid transformations, the radius holds */
+		if (!frustum.intersectsSphere(occluder.transformation.translation(), occluder.shape->radius))
+		{ continue; }
+
+		const f32mat4 transformation = viewProjection * occluder.transformation;
+		vector<f32vec3> const& vertices = occluder.shape->triangles;
+		for (std::size_t i = 0; i < vertices.size(); i += 3)
+		{
+			const f32vec4 clip[3]{transformation * f32vec4{vertices[i], 1.f},
+			                      transformation * f32vec4{vertices[i + 1], 1.f},
+			                      transformation * f32vec4{vertices[i + 2], 1.f}};
+			setup(clip);
+		}
+	}
+
+	constexpr std::size_t bands = Height / BandHeight;
+	if (pool)
+	{
+		pool->parallelFor(bands, 1, [this](std::size_t first, std::size_t last)
+		{
+			for (std::size_t band = first; band < last; ++band)
+			{ rasterizeBand(i32(band)); }
+		});
+	}
+	else
+	{
+		for (std::size_t band = 0; band < bands; ++band)
+		{ rasterizeBand(i32(band)); }
+	}
+}
+
+bool OcclusionCuller::isOccluded(f32vec3 const& center, f32 radius) const
+{
+	if (!_enabled || _triangles.empty())
+	{ return false; }
+
+	/* Corners of the box around the sphere, their nearest depth bounds the sphere's */
+	f32vec2 lo{Constants::inf()}, hi{-Constants::inf()};
+	f32 nearest = 0.f;
+	for (u32 i = 0; i < 8; ++i)
+	{
+		const f32vec3 corner = center + radius * f32vec3{i & 1 ? 1.f : -1.f, i & 2 ? 1.f : -1.f, i & 4 ? 1.f : -1.f};
+		const f32vec4 clip = _viewProjection * f32vec4{corner, 1.f};
+		if (clip.w() - clip.z() <= 0.f)
+		{ return false; }
+
+		const f32vec3 ndc = clip.xyz() / clip.w();
+		lo = Math::min(lo, ndc.xy());
+		hi = Math::max(hi, ndc.xy());
+		nearest = Math::max(nearest, ndc.z());
+	}
+
+	const f32vec2 size{f32(Width), f32(Height)};
+	lo = (lo * 0.5f + f32vec2{0.5f}) * size;
+	hi = (hi * 0.5f + f32vec2{0.5f}) * size;
+	if (hi.x() < 0.f || hi.y() < 0.f || lo.x() >= size.x() || lo.y() >= size.y())
+	{ return false; }
+
+	const i32 x0 = i32(Math::max(lo.x(), 0.f)) / TileSize, x1 = i32(Math::min(hi.x(), size.x() - 1.f)) / TileSize;
+	const i32 y0 = i32(Math::max(lo.y(), 0.f)) / TileSize, y1 = i32(Math::min(hi.y(), size.y() - 1.f)) / TileSize;
+	for (i32 y = y0; y <= y1; ++y)
+	{
+		for (i32 x = x0; x <= x1; ++x)
+		{
+			if (_tiles[std::size_t(y * TilesX + x)] <= nearest)
+			{ return false; }
+		}
+	}
+	return true;
+}
+
+void OcclusionCuller::setup(f32vec4 const (& clip)[3])
+{
+	/* Only the near plane needs clipping, the bounds clamp everything else to the screen */
+	f32vec4 polygon[4];
+	u32 count = 0;
+	for (u32 i = 0; i < 3; ++i)
+	{
+		f32vec4 const& a = clip[i], & b = clip[(i + 1) % 3];
+		const f32 da = a.w() - a.z(), db = b.w() - b.z();
+		if (da >= 0.f)
+		{ polygon[count++] = a; }
+		if ((da >= 0.f) != (db >= 0.f))
+		{ polygon[count++] = Math::lerp(a, b, da / (da - db)); }
+	}
+	if (count < 3)
+	{ return; }
+
+	f32vec3 screen[4];
+	for (u32 i = 0; i < count; ++i)
+	{
+		const f32vec3 ndc = polygon[i].xyz() / polygon[i].w();
+		screen[i] = {(ndc.x() * 0.5f + 0.5f) * f32(Width), (ndc.y() * 0.5f + 0.5f) * f32(Height), ndc.z()};
+	}
+
+	for (u32 i = 1; i + 1 < count; ++i)
+	{
+		f32vec3 const& v0 = screen[0], & v1 = screen[i], & v2 = screen[i + 1];
+		const f32vec3 e1 = v1 - v0, e2 = v2 - v0;
+		const f32 area = e1.x() * e2.y() - e1.y() * e2.x();
+		/* Back faces and slivers */
+		if (area <= 0.f)
+		{ continue; }
+
+		Triangle triangle{};
+		triangle.minX = Math::max(i32(std::ceil(std::min({v0.x(), v1.x(), v2.x()}) - 0.5f)), 0);
+		triangle.maxX = Math::min(i32(std::floor(std::max({v0.x(), v1.x(), v2.x()}) - 0.5f)), Width - 1);
+		triangle.minY = Math::max(i32(std::ceil(std::min({v0.y(), v1.y(), v2.y()}) - 0.5f)), 0);
+		triangle.maxY = Math::min(i32(std::floor(std::max({v0.y(), v1.y(), v2.y()}) - 0.5f)), Height - 1);
+		if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+		{ continue; }
+
+		/* Positive on the inner side of each edge */
+		f32vec3 const* corners[3]{&v0, &v1, &v2};
+		for (u32 e = 0; e < 3; ++e)
+		{
+			f32vec3 const& a = *corners[e], & b = *corners[(e + 1) % 3];
+			const f32 dx = a.y() - b.y(), dy = b.x() - a.x();
+			triangle.edges[e] = {dx, dy, -(dx * a.x() + dy * a.y())};
+		}
+
+		/* Pulled back by half a pixel of slope, so no part of a pixel is nearer than what gets stored */
+		const f32 dzdx = (e1.z() * e2.y() - e2.z() * e1.y()) / area, dzdy = (e2.z() * e1.x() - e1.z() * e2.x()) / area;
+		triangle.depth = {dzdx, dzdy, v0.z() - dzdx * v0.x() - dzdy * v0.y() -
+		                              0.5f * (std::abs(dzdx) + std::abs(dzdy))};
+		_triangles.push_back(triangle);
+	}
+}
+
+void OcclusionCuller::rasterizeBand(i32 band)
+{
+	const i32 top = band * BandHeight, bottom = top + BandHeight;
+	std::fill(_depth.begin() + top * Width, _depth.begin() + bottom * Width, 0.f);
+
+	for (Triangle const& triangle: _triangles)
+	{
+		f32vec3 const (& edges)[3] = triangle.edges;
+		f32vec3 const& plane = triangle.depth;
+		/* Aligned to the lanes, pixels the bounds don't cover fail the edge tests */
+		const i32 minX = triangle.minX & ~3;
+
+		for (i32 y = Math::max(triangle.minY, top), maxY = Math::min(triangle.maxY, bottom - 1); y <= maxY; ++y)
+		{
+			const f32 py = f32(y) + 0.5f;
+			const f32 row0 = edges[0].y() * py + edges[0].z(), row1 = edges[1].y() * py + edges[1].z(),
+					row2 = edges[2].y() * py + edges[2].z(), rowZ = plane.y() * py + plane.z();
+			f32* out = _depth.data() + y * Width;
+
+#ifdef ASTEROPE_OCCLUSION_SSE
+			const __m128 a0 = _mm_set1_ps(edges[0].x()), a1 = _mm_set1_ps(edges[1].x());
+			const __m128 a2 = _mm_set1_ps(edges[2].x()), c0 = _mm_set1_ps(row0);
+			const __m128 c1 = _mm_set1_ps(row1), c2 = _mm_set1_ps(row2);
+			const __m128 dz = _mm_set1_ps(plane.x()), cz = _mm_set1_ps(rowZ), zero = _mm_setzero_ps();
+			const __m128 lanes = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+			for (i32 x = minX; x <= triangle.maxX; x += 4)
+			{
+				const __m128 px = _mm_add_ps(_mm_set1_ps(f32(x)), lanes);
+				const __m128 inside = _mm_and_ps(
+						_mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, px), c0), zero),
+						           _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, px), c1), zero)),
+						_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, px), c2), zero));
+				const __m128 stored = _mm_loadu_ps(out + x);
+				const __m128 nearer = _mm_max_ps(stored, _mm_add_ps(_mm_mul_ps(dz, px), cz));
+				_mm_storeu_ps(out + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, stored)));
+			}
+#else
+			for (i32 x = minX; x <= triangle.maxX; ++x)
+			{
+				const f32 px = f32(x) + 0.5f;
+				if (edges[0].x() * px + row0 >= 0.f && edges[1].x() * px + row1 >= 0.f &&
+				    edges[2].x() * px + row2 >= 0.f)
+				{ out[x] = Math::max(out[x], plane.x() * px + rowZ); }
+			}
+#endif
+		}
+	}
+
+	/* Farthest depth of each tile, anything behind it is behind the whole tile */
+	for (i32 ty = top / TileSize; ty < bottom / TileSize; ++ty)
+	{
+		for (i32 tx = 0; tx < TilesX; ++tx)
+		{
+			f32 farthest = 1.f;
+			for (i32 y = ty * TileSize; y < (ty + 1) * TileSize; ++y)
+			{
+				f32 const* row = _depth.data() + y * Width + tx * TileSize;
+				farthest = Math::min(farthest, *std::min_element(row, row + TileSize));
+			}
+			_tiles[std::size_t(ty * TilesX + tx)] = farthest;
+		}
+	}
+}
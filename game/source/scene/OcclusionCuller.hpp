@@ -0,0 +1,77 @@
+#pragma once
+
+#include "../jobs/ThreadPool.hpp"
+#include "../Types.hpp"
+#include "Frustum.hpp"
+
+struct OccluderComponent;
+
+/* Software depth buffer for occlusion culling. Every frame the few large OccluderComponent shapes are rasterized at
+ * Width x Height on the CPU, then reduced to a TileSize hierarchical level holding the farthest depth of each tile;
+ * isOccluded() tests bounds against that level before anything gets queued, so hidden entities cost no draw and the
+ * answer is there the same frame, unlike GPU queries. Rows are split in bands rasterized on the thread pool, four
+ * pixels at a time with SSE when available. Depth is reversed like the scene, 1 on the near plane and 0 at infinity.
+ * Nothing here touches GL, so the culler runs just as well without a context. */
+class OcclusionCuller
+{
+public:
+	static constexpr i32 Width = 256, Height = 144;
+	static constexpr i32 TileSize = 8, BandHeight = 16;
+	static constexpr i32 TilesX = Width / TileSize, TilesY = Height / TileSize;
+
+	static_assert(Width % TileSize == 0 && Height % BandHeight == 0 && BandHeight % TileSize == 0);
+
+	struct Occluder
+	{
+		/* Relative to the same origin as the view projection given to render() */
+		f32mat4 transformation;
+		OccluderComponent const* shape;
+	};
+
+	OcclusionCuller();
+
+	void setEnabled(bool enabled)
+	{ _enabled = enabled; }
+
+	[[nodiscard]] bool isEnabled() const
+	{ return _enabled; }
+
+	/* Clears the buffer and rasterizes occluders as seen through viewProjection, a reversed-Z projection like
+	 * Scene::createReverseProjectionMatrix() makes. Only occluders intersecting frustum are transformed. */
+	void render(f32mat4 const& viewProjection, Frustum const& frustum, span<Occluder const> occluders,
+	            ThreadPool* pool);
+
+	/* Whether the sphere is entirely behind what render() drew, false when disabled. Bounds crossing the near plane
+	 * or leaving the screen are never occluded, the frustum test is the one to drop those. */
+	[[nodiscard]] bool isOccluded(f32vec3 const& center, f32 radius) const;
+
+	/* Rows bottom-up, like GL images */
+	[[nodiscard]] span<f32 const> depth() const
+	{ return _depth; }
+
+	[[nodiscard]] span<f32 const> hierarchicalDepth() const
+	{ return _tiles; }
+
+	/* Triangles the last render() rasterized, after clipping and back-face culling */
+	[[nodiscard]] std::size_t triangleCount() const
+	{ return _triangles.size(); }
+
+private:
+	/* Edge functions and depth plane in pixel coordinates, evaluated at pixel centers */
+	struct Triangle
+	{
+		f32vec3 edges[3];
+		f32vec3 depth;
+		i32 minX, maxX, minY, maxY;
+	};
+
+	vector<f32> _depth{};
+	vector<f32> _tiles{};
+	vector<Triangle> _triangles{};
+	f32mat4 _viewProjection{};
+	bool _enabled{true};
+
+	void setup(f32vec4 const (& clip)[3]);
+
+	void rasterizeBand(i32 band);
+};
@@ -0,0 +1,253 @@
+#include <Magnum/Shaders/GenericGL.h>
+#include <Magnum/GL/Mesh.h>
+#include <algorithm>
+#include <chrono>
+
+#include "PlanetTerrain.hpp"
+
+using namespace Magnum;
+
+namespace
+{
+	constexpr u32 Resolution = PlanetTerrain::Resolution;
+	constexpr u32 GridVertexCount = (Resolution + 1) * (Resolution + 1);
+	constexpr u32 SkirtVertexCount = 4 * Resolution;
+	constexpr u32 IndexCount = 6 * Resolution * Resolution + 6 * SkirtVertexCount;
+
+	/* Normal, then u and v axes of every cube face, u x v points outwards so grids wind counter-clockwise */
+	constexpr array<array<f64vec3, 3>, 6> Faces{{
+			{{{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}}},
+			{{{-1.0, 0.0, 0.0}, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}}},
+			{{{0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}, {1.0, 0.0, 0.0}}},
+			{{{0.0, -1.0, 0.0}, {1.0, 0.0, 0.0}, {0.0, 0.0, 1.0}}},
+			{{{0.0, 0.0, 1.0}, {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}}},
+			{{{0.0, 0.0, -1.0}, {0.0, 1.0, 0.0}, {1.0, 0.0, 0.0}}}
+	}};
+
+	/* Face in the top 3 bits, level in the next 5, then 28 bits for each of x and y */
+	struct Node
+	{
+		u32 face, level, x, y;
+	};
+
+	u64 makeKey(u32 face, u32 level, u32 x, u32 y)
+	{ return u64(face) << 61 | u64(level) << 56 | u64(x) << 28 | u64(y); }
+
+	Node decode(u64 key)
+	{
+		constexpr u64 mask = (u64(1) << 28) - 1;
+		return {u32(key >> 61), u32(key >> 56) & 31, u32(key >> 28 & mask), u32(key & mask)};
+	}
+
+	/* Unit direction of a point of a face, s and t in [0, 1]. The spherified cube mapping keeps cells far more even
+	 * in size than normalizing the cube point would. */
+	f64vec3 direction(u32 face, f64 s, f64 t)
+	{
+		const f64vec3 p = Faces[face][0] + Faces[face][1] * (2.0 * s - 1.0) + Faces[face][2] * (2.0 * t - 1.0);
+		const f64vec3 p2 = p * p;
+		return f64vec3{p.x() * Math::sqrt(1.0 - p2.y() / 2.0 - p2.z() / 2.0 + p2.y() * p2.z() / 3.0),
+		               p.y() * Math::sqrt(1.0 - p2.z() / 2.0 - p2.x() / 2.0 + p2.z() * p2.x() / 3.0),
+		               p.z() * Math::sqrt(1.0 - p2.x() / 2.0 - p2.y() / 2.0 + p2.x() * p2.y() / 3.0)}.normalized();
+	}
+
+	u32 gridIndex(u32 i, u32 j)
+	{ return j * (Resolution + 1) + i; }
+
+	/* Grid vertices along the chunk border, counter-clockwise, every corner once */
+	array<u32, SkirtVertexCount> borderLoop()
+	{
+		array<u32, SkirtVertexCount> ret{};
+		u32 k = 0;
+		for (u32 i = 0; i < Resolution; ++i)
+		{ ret[k++] = gridIndex(i, 0); }
+		for (u32 j = 0; j < Resolution; ++j)
+		{ ret[k++] = gridIndex(Resolution, j); }
+		for (u32 i = Resolution; i > 0; --i)
+		{ ret[k++] = gridIndex(i, Resolution); }
+		for (u32 j = Resolution; j > 0; --j)
+		{ ret[k++] = gridIndex(0, j); }
+		return ret;
+	}
+}
+
+PlanetTerrain::PlanetTerrain(f64 radius, u32 maxDepth, std::size_t capacity, HeightFn height)
+		: _radius{radius}, _maxDepth{maxDepth}, _capacity{capacity}, _height{std::move(height)}
+{
+	CORRADE_ASSERT(maxDepth <= 27, "PlanetTerrain: maxDepth can't exceed 27", );
+	static_assert(GridVertexCount + SkirtVertexCount <= 65536, "PlanetTerrain: chunks must fit 16 bit indices");
+
+	/* Every chunk shares one topology */
+	vector<u16> indices;
+	indices.reserve(IndexCount);
+	for (u32 j = 0; j < Resolution; ++j)
+	{
+		for (u32 i = 0; i < Resolution; ++i)
+		{
+			const u16 a = u16(gridIndex(i, j)), b = u16(gridIndex(i + 1, j)),
+					c = u16(gridIndex(i + 1, j + 1)), d = u16(gridIndex(i, j + 1));
+			indices.insert(indices.end(), {a, b, c, a, c, d});
+		}
+	}
+
+	const array<u32, SkirtVertexCount> border = borderLoop();
+	for (u32 k = 0; k < SkirtVertexCount; ++k)
+	{
+		const u32 next = (k + 1) % SkirtVertexCount;
+		const u16 a = u16(border[k]), b = u16(border[next]),
+				skirtA = u16(GridVertexCount + k), skirtB = u16(GridVertexCount + next);
+		indices.insert(indices.end(), {a, skirtA, skirtB, a, skirtB, b});
+	}
+
+	_indices = GL::Buffer{GL::Buffer::TargetHint::ElementArray, Containers::arrayView(indices.data(), indices.size())};
+}
+
+void PlanetTerrain::update(f64vec3 const& camera, ThreadPool& jobs, vector<Chunk*>& selection)
+{
+	++_frame;
+
+	for (auto it = _pending.begin(); it != _pending.end();)
+	{
+		if (it->second.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+		{
+			++it;
+			continue;
+		}
+
+		ChunkData data = it->second.get();
+		Chunk chunk{};
+		chunk.center = data.center;
+		chunk.radius = data.radius;
+		chunk.gpu.mesh.setPrimitive(GL::MeshPrimitive::Triangles)
+		              .setCount(i32(IndexCount))
+		              .addVertexBuffer(GL::Buffer{GL::Buffer::TargetHint::Array,
+		                                          Containers::arrayView(data.vertices.data(), data.vertices.size())},
+		                               0, Shaders::GenericGL3D::Position{}, Shaders::GenericGL3D::Normal{})
+		              .setIndexBuffer(_indices, 0, GL::MeshIndexType::UnsignedShort);
+		_resident.insert_or_assign(it->first, Resident{std::move(chunk), _frame, false});
+		it = _pending.erase(it);
+	}
+
+	selection.clear();
+	for (u32 face = 0; face < 6; ++face)
+	{ select(makeKey(face, 0, 0, 0), camera, jobs, selection); }
+
+	evict();
+}
+
+void PlanetTerrain::select(u64 key, f64vec3 const& camera, ThreadPool& jobs, vector<Chunk*>& selection)
+{
+	const Node node = decode(key);
+	const auto it = _resident.find(key);
+	const bool resident = it != _resident.end();
+	if (resident)
+	{ it->second.lastUsed = _frame; }
+
+	/* Distance to the node on the bare sphere, minus about half its diagonal */
+	const f64 scale = 1.0 / f64(1u << node.level);
+	const f64 edge = _radius * f64const::piHalf() * scale;
+	const f64vec3 center = _radius * direction(node.face, (f64(node.x) + 0.5) * scale, (f64(node.y) + 0.5) * scale);
+	const f64 distance = Math::max((camera - center).length() - 0.75 * edge, 0.0);
+	/* Merging needs a bit more distance than splitting, so nodes don't flicker on the boundary */
+	const f64 hysteresis = resident && it->second.split ? 1.25 : 1.0;
+
+	bool split = node.level < _maxDepth && distance < SplitDistance * hysteresis * edge;
+	array<u64, 4> children{};
+	if (split)
+	{
+		for (u32 i = 0; i < 4; ++i)
+		{
+			children[i] = makeKey(node.face, node.level + 1, node.x * 2 + (i & 1), node.y * 2 + (i >> 1));
+			if (!_resident.contains(children[i]))
+			{
+				request(children[i], jobs);
+				split = false;
+			}
+		}
+	}
+
+	if (resident)
+	{ it->second.split = split; }
+	if (split)
+	{
+		for (u64 child: children)
+		{ select(child, camera, jobs, selection); }
+	}
+	else if (resident)
+	{ selection.push_back(&it->second.chunk); }
+	else
+	{ request(key, jobs); }
+}
+
+void PlanetTerrain::request(u64 key, ThreadPool& jobs)
+{
+	if (_pending.size() >= MaxPending || _pending.contains(key))
+	{ return; }
+
+	_pending.emplace(key, jobs.submit([key, radius = _radius, height = _height]()
+	                                  { return generate(key, radius, height); }));
+}
+
+void PlanetTerrain::evict()
+{
+	if (_resident.size() <= _capacity)
+	{ return; }
+
+	/* Chunks used this frame hold the selection and its ancestors, they never go */
+	vector<std::pair<u64, u64>> candidates;
+	for (auto const& [key, resident]: _resident)
+	{
+		if (resident.lastUsed != _frame)
+		{ candidates.emplace_back(resident.lastUsed, key); }
+	}
+
+	const std::size_t count = Math::min(_resident.size() - _capacity, candidates.size());
+	std::partial_sort(candidates.begin(), candidates.begin() + std::ptrdiff_t(count), candidates.end());
+	for (std::size_t i = 0; i < count; ++i)
+	{ _resident.erase(candidates[i].second); }
+}
+
+PlanetTerrain::ChunkData PlanetTerrain::generate(u64 key, f64 radius, HeightFn const& height)
+{
+	const Node node = decode(key);
+	const f64 scale = 1.0 / f64(1u << node.level);
+
+	ChunkData ret{};
+	ret.center = radius * direction(node.face, (f64(node.x) + 0.5) * scale, (f64(node.y) + 0.5) * scale);
+
+	vector<f64vec3> grid(GridVertexCount);
+	for (u32 j = 0; j <= Resolution; ++j)
+	{
+		for (u32 i = 0; i <= Resolution; ++i)
+		{
+			const f64vec3 dir = direction(node.face, (f64(node.x) + f64(i) / Resolution) * scale,
+			                              (f64(node.y) + f64(j) / Resolution) * scale);
+			grid[gridIndex(i, j)] = dir * (radius + (height ? height(dir) : 0.0)) - ret.center;
+		}
+	}
+
+	ret.vertices.resize(GridVertexCount + SkirtVertexCount);
+	for (u32 j = 0; j <= Resolution; ++j)
+	{
+		for (u32 i = 0; i <= Resolution; ++i)
+		{
+			/* Central differences, one-sided on the border */
+			const f64vec3 du = grid[gridIndex(Math::min(i + 1, Resolution), j)] - grid[gridIndex(i > 0 ? i - 1 : 0, j)];
+			const f64vec3 dv = grid[gridIndex(i, Math::min(j + 1, Resolution))] - grid[gridIndex(i, j > 0 ? j - 1 : 0)];
+			ret.vertices[gridIndex(i, j)] = {f32vec3{grid[gridIndex(i, j)]}, f32vec3{Math::cross(du, dv).normalized()}};
+		}
+	}
+
+	/* Deep enough to cover the sag of a neighbour one level coarser */
+	const f64 skirt = 2.0 * radius * f64const::piHalf() * scale / Resolution;
+	const array<u32, SkirtVertexCount> border = borderLoop();
+	for (u32 k = 0; k < SkirtVertexCount; ++k)
+	{
+		const f64vec3 down = -(grid[border[k]] + ret.center).normalized();
+		ret.vertices[GridVertexCount + k] = {f32vec3{grid[border[k]] + down * skirt}, ret.vertices[border[k]].normal};
+	}
+
+	ret.radius = 0.f;
+	for (Vertex const& vertex: ret.vertices)
+	{ ret.radius = Math::max(ret.radius, vertex.position.length()); }
+	return ret;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <Magnum/GL/Buffer.h>
+#include <unordered_map>
+#include <future>
+
+#include "../jobs/ThreadPool.hpp"
+#include "Components.hpp"
+#include "../Types.hpp"
+
+/* Planet surface as six quadtrees over a spherified cube. Every node is a chunk of Resolution by Resolution quads with
+ * skirts hiding the cracks between neighbours of different levels. Nodes split when the camera gets within
+ * SplitDistance of their edge length and merge back past a slightly larger distance, so the triangle count near the
+ * camera stays about constant whatever the planet size. Chunks are generated on ThreadPool workers, at most
+ * MaxPending at a time; a node keeps being drawn until its four children are resident. Resident chunks are capped to
+ * the pool capacity, the least recently used ones get evicted first. Vertices are relative to the chunk center, in
+ * planet space, so they stay precise with any radius; the renderer places chunks relative to the camera. */
+class PlanetTerrain
+{
+public:
+	/* Height above the radius along a unit direction in planet space, called from worker threads */
+	using HeightFn = function<f64(f64vec3 const&)>;
+
+	static constexpr u32 Resolution = 16;
+	static constexpr f64 SplitDistance = 2.0;
+	static constexpr u32 MaxPending = 16;
+
+	struct Chunk
+	{
+		GpuMesh gpu{};
+		/* Bounding sphere in planet space */
+		f64vec3 center{};
+		f32 radius{0.f};
+	};
+
+	explicit PlanetTerrain(f64 radius, u32 maxDepth = 20, std::size_t capacity = 1024, HeightFn height = {});
+
+	PlanetTerrain(PlanetTerrain const&) = delete;
+
+	PlanetTerrain& operator=(PlanetTerrain const&) = delete;
+
+	[[nodiscard]] f64 radius() const
+	{ return _radius; }
+
+	/* Uploads finished chunks, refines the trees around camera, given in planet space, and replaces selection with
+	 * the chunks to draw this frame */
+	void update(f64vec3 const& camera, ThreadPool& jobs, vector<Chunk*>& selection);
+
+	[[nodiscard]] std::size_t residentCount() const
+	{ return _resident.size(); }
+
+	[[nodiscard]] std::size_t pendingCount() const
+	{ return _pending.size(); }
+
+private:
+	struct Vertex
+	{
+		f32vec3 position;
+		f32vec3 normal;
+	};
+
+	struct ChunkData
+	{
+		vector<Vertex> vertices;
+		f64vec3 center;
+		f32 radius;
+	};
+
+	struct Resident
+	{
+		Chunk chunk;
+		u64 lastUsed;
+		bool split;
+	};
+
+	f64 _radius;
+	u32 _maxDepth;
+	std::size_t _capacity;
+	HeightFn _height;
+	u64 _frame{0};
+	Magnum::GL::Buffer _indices{NoCreate};
+	std::unordered_map<u64, Resident> _resident{};
+	std::unordered_map<u64, std::future<ChunkData>> _pending{};
+
+	void select(u64 key, f64vec3 const& camera, ThreadPool& jobs, vector<Chunk*>& selection);
+
+	void request(u64 key, ThreadPool& jobs);
+
+	void evict();
+
+	static ChunkData generate(u64 key, f64 radius, HeightFn const& height);
+};
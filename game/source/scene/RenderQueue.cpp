@@ -0,0 +1,52 @@
+#include <algorithm>
+
+#include "RenderQueue.hpp"
+
+void RenderQueue::clear()
+{
+	_items.clear();
+	_materialIds.clear();
+	_meshIds.clear();
+}
+
+u64 RenderQueue::id(std::unordered_map<void const*, u32>& ids, void const* ptr, u32 bits)
+{
+	auto [it, inserted] = ids.try_emplace(ptr, u32(ids.size()));
+	return u64(it->second) & ((u64{1} << bits) - 1);
+}
+
+void RenderQueue::push(Pass pass, u8 shader, GpuMesh* mesh, void const* material, f32 depth, entt::entity entity)
+{
+	static_assert(1 + ShaderBits + MaterialBits + MeshBits + DepthBits <= 64);
+
+	/* Positive floats sort like their bit patterns, the top bits are a monotonic depth */
+	const u64 quantized = bit_cast<u32>(std::max(depth, 0.f)) >> (32 - DepthBits);
+	const u64 state = (u64(shader) & ((u64{1} << ShaderBits) - 1)) << (MaterialBits + MeshBits) |
+	                  id(_materialIds, material, MaterialBits) << MeshBits |
+	                  id(_meshIds, mesh, MeshBits);
+
+	u64 key = u64(pass) << 63;
+	if (pass == Pass::Opaque)
+	{ key |= state << DepthBits | quantized; }
+	else
+	{ key |= (((u64{1} << DepthBits) - 1) - quantized) << (ShaderBits + MaterialBits + MeshBits) | state; }
+
+	_items.push_back({key, shader, mesh, material, entity});
+}
+
+void RenderQueue::sort()
+{
+	std::sort(_items.begin(), _items.end(), [](Item const& a, Item const& b)
+	{ return a.key < b.key; });
+}
+
+std::size_t RenderQueue::batchEnd(std::size_t first) const
+{
+	Item const& batch = _items[first];
+	std::size_t last = first + 1;
+	while (last < _items.size() && (_items[last].key >> 63) == (batch.key >> 63) &&
+	       _items[last].shader == batch.shader && _items[last].mesh == batch.mesh &&
+	       _items[last].material == batch.material)
+	{ ++last; }
+	return last;
+}
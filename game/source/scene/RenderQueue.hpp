@@ -0,0 +1,56 @@
+#pragma once
+
+#include <entt/entity/entity.hpp>
+#include <unordered_map>
+
+#include "Components.hpp"
+#include "../Types.hpp"
+
+/* Draws collected during a frame and sorted by a packed 64 bit key. Opaque items are ordered by shader, material,
+ * mesh and then front-to-back, so state changes are rare and early-z rejects as much as it can. Blended items are
+ * ordered back-to-front first, state second. */
+class RenderQueue
+{
+public:
+	enum class Pass : u8
+	{
+		Opaque,
+		Blended
+	};
+
+	struct Item
+	{
+		u64 key;
+		u8 shader;
+		GpuMesh* mesh;
+		void const* material;
+		entt::entity entity;
+	};
+
+	static constexpr u32 ShaderBits = 4;
+	static constexpr u32 MaterialBits = 16;
+	static constexpr u32 MeshBits = 18;
+	static constexpr u32 DepthBits = 24;
+
+	RenderQueue() = default;
+
+	void clear();
+
+	/* depth is the distance to the camera, material may be null */
+	void push(Pass pass, u8 shader, GpuMesh* mesh, void const* material, f32 depth, entt::entity entity);
+
+	void sort();
+
+	[[nodiscard]] span<Item const> items() const
+	{ return _items; }
+
+	/* End of the run starting at first that shares pass, shader, mesh and material, drawable as one batch */
+	[[nodiscard]] std::size_t batchEnd(std::size_t first) const;
+
+private:
+	vector<Item> _items{};
+	std::unordered_map<void const*, u32> _materialIds{}, _meshIds{};
+
+	/* Sequential per-frame id, wraps around past bits; keys only need to keep equal states together */
+	static u64 id(std::unordered_map<void const*, u32>& ids, void const* ptr, u32 bits);
+};
@@ -1,10 +1,11 @@
-#include <Magnum/Trade/AbstractImporter.h>
+#include <Corrade/Containers/ArrayView.h>
 #include <Magnum/GL/DefaultFramebuffer.h>
+#include <Magnum/MeshTools/Compile.h>
 #include <Magnum/GL/TextureFormat.h>
-#include <Magnum/Trade/ImageData.h>
+#include <Magnum/Shaders/Generic.h>
+#include <Magnum/Trade/MeshData.h>
+#include <Magnum/Shaders/Flat.h>
 #include <Magnum/GL/Renderer.h>
-#include <Magnum/ImageView.h>
-#include <filesystem>
 
 #include "../imgui/ScreenImContext.hpp"
 #include "Scene.hpp"
@@ -12,42 +13,21 @@
 using namespace Magnum;
 using namespace entt;
 
-static GL::Texture2D loadTexture(std::filesystem::path const& filename, Containers::Pointer<Trade::AbstractImporter>& importer)
+MeshComponent::MeshComponent(Trade::MeshData const& data)
+		: gpu{std::make_shared<GpuMesh>(GpuMesh{MeshTools::compile(data)})}
 {
-	if (!importer->openFile(filename.string().c_str()))
-	{
-		Fatal{} << "Could not load texture" << filename.string();
-		std::exit(1);
-	}
-
-	GL::Texture2D ret{};
-	Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
-	CORRADE_INTERNAL_ASSERT(image);
-
-	ret.setWrapping(GL::SamplerWrapping::ClampToEdge)
-	   .setMagnificationFilter(GL::SamplerFilter::Linear)
-	   .setMinificationFilter(GL::SamplerFilter::Linear)
-	   .setStorage(1, GL::textureFormat(image->format()), image->size())
-	   .setSubImage(0, {}, *image);
-	return ret;
-}
+	const Containers::Array<f32vec3> positions = data.positions3DAsArray();
+	if (positions.isEmpty())
+	{ return; }
 
-void PhysicalMaterialComponent::loadTextures()
-{
-	Corrade::PluginManager::Manager<Trade::AbstractImporter> manager;
-	Containers::Pointer<Trade::AbstractImporter> importer = manager.loadAndInstantiate("StbImageImporter");
-	if (!importer)
-	{
-		Fatal{} << "Could not load plugin StbImageImporter";
-		std::exit(1);
-	}
+	f32range3 box{positions[0], positions[0]};
+	for (f32vec3 const& position: positions)
+	{ box = Math::join(box, f32range3{position, position}); }
 
-	std::filesystem::path textures{path};
-	albedo = loadTexture(textures / "albedo.png", importer);
-	ambientOcclusion = loadTexture(textures / "ao.png", importer);
-	metallic = loadTexture(textures / "metallic.png", importer);
-	normal = loadTexture(textures / "normal.png", importer);
-	roughness = loadTexture(textures / "roughness.png", importer);
+	center = box.center();
+	radius = 0.f;
+	for (f32vec3 const& position: positions)
+	{ radius = Math::max(radius, (position - center).length()); }
 }
 
 f32mat4 Scene::createReverseProjectionMatrix(f32rad fov, f32 aspectRation, f32 near)
@@ -72,11 +52,50 @@ void Scene::create(i32vec2 const& size, u32 lightCount)
 	GL::Renderer::setClipControl(GL::Renderer::ClipOrigin::LowerLeft, GL::Renderer::ClipDepth::ZeroToOne);
 
 	_size = size;
+	_jobs = std::make_unique<ThreadPool>();
+	SpatialIndex::connect(_reg);
 	_phong = Shaders::PhongGL{Shaders::PhongGL::Configuration{}
-			                          .setFlags(Shaders::PhongGL::Flag::ObjectId)};
+			                          .setFlags(Shaders::PhongGL::Flag::UniformBuffers |
+			                                    Shaders::PhongGL::Flag::InstancedObjectId |
+			                                    Shaders::PhongGL::Flag::InstancedTransformation |
+			                                    Shaders::PhongGL::Flag::VertexColor)
+			                          .setLightCount(lightCount)};
 	_flat = Shaders::FlatGL3D{Shaders::FlatGL3D::Configuration{}
-			                          .setFlags(Shaders::FlatGL3D::Flag::Textured | Shaders::FlatGL3D::Flag::AlphaMask)};
-	_pbr = PhysicalShader{lightCount};
+			                          .setFlags(Shaders::FlatGL3D::Flag::UniformBuffers |
+			                                    Shaders::FlatGL3D::Flag::Textured |
+			                                    Shaders::FlatGL3D::Flag::AlphaMask |
+			                                    Shaders::FlatGL3D::Flag::InstancedTransformation)};
+	_programs = ProgramBinaryCache{"cache/shaders"};
+	_pbr = PhysicalShader{PhysicalShader::Flag::InstancedTransformation, &_programs};
+	_pbrDepth = DepthShader{PhysicalShader::Flag::InstancedTransformation, &_programs};
+	_impostor = ImpostorShader{&_programs};
+	_billboard = _meshes.planeSolid().gpu;
+
+	_frameUniforms = GL::Buffer{GL::Buffer::TargetHint::Uniform};
+	_frameUniforms.setData({nullptr, sizeof(PhysicalShader::FrameUniform)}, GL::BufferUsage::DynamicDraw);
+	_phongLights = GL::Buffer{GL::Buffer::TargetHint::Uniform};
+	_phongLights.setData({nullptr, lightCount * sizeof(Shaders::PhongLightUniform)}, GL::BufferUsage::DynamicDraw);
+	_phongMaterial = GL::Buffer{GL::Buffer::TargetHint::Uniform, {Shaders::PhongMaterialUniform{}}};
+	_identityTransformation = GL::Buffer{GL::Buffer::TargetHint::Uniform, {Shaders::TransformationUniform3D{}}};
+	_phongDraw = GL::Buffer{GL::Buffer::TargetHint::Uniform, {Shaders::PhongDrawUniform{}}};
+	_flatDraw = GL::Buffer{GL::Buffer::TargetHint::Uniform, {Shaders::FlatDrawUniform{}}};
+	_flatMaterial = GL::Buffer{GL::Buffer::TargetHint::Uniform, {Shaders::FlatMaterialUniform{}}};
+	_drawBuffer = GL::Buffer{GL::Buffer::TargetHint::ShaderStorage};
+	_instanceBuffer = GL::Buffer{GL::Buffer::TargetHint::Array};
+	_lightClusters = LightClusters{};
+	_resolution = DynamicResolution{};
+	_readback = FrameReadback{};
+	_renderSize = size;
+
+	_screensPass = _profiler.pass("Screens");
+	_entitiesPass = _profiler.pass("Entities");
+	_depthPass = _profiler.pass("Entities: depth pre-pass");
+	_shaderPasses[u8(DrawShader::Phong)] = _profiler.pass("Entities: Phong");
+	_shaderPasses[u8(DrawShader::Physical)] = _profiler.pass("Entities: Physical");
+	_shaderPasses[u8(DrawShader::Impostor)] = _profiler.pass("Entities: Impostor");
+	_shaderPasses[u8(DrawShader::Terrain)] = _profiler.pass("Entities: Terrain");
+	_shaderPasses[u8(DrawShader::Flat)] = _profiler.pass("Entities: Flat");
+	_blitPass = _profiler.pass("Blit");
 
 	_color = GL::Texture2D{};
 	_color.setStorage(1, GL::TextureFormat::RGBA8, size);
@@ -87,42 +106,107 @@ void Scene::create(i32vec2 const& size, u32 lightCount)
 	_fbo = GL::Framebuffer{i32range2{{{}, size}}};
 	_fbo.attachTexture(GL::Framebuffer::ColorAttachment{0}, _color, 0)
 	    .attachTexture(GL::Framebuffer::BufferAttachment::Depth, _depth, 0)
-	    .mapForDraw({{Shaders::PhongGL::ColorOutput, GL::Framebuffer::ColorAttachment{0}}});
+	    .mapForDraw({{Shaders::PhongGL::ColorOutput, GL::Framebuffer::ColorAttachment{0}}})
+	    .mapForRead(GL::Framebuffer::ColorAttachment{0});
 	CORRADE_INTERNAL_ASSERT(_fbo.checkStatus(GL::FramebufferTarget::Draw) == GL::Framebuffer::Status::Complete);
 }
 
 void Scene::blitToDefaultFramebuffer()
 {
-	GL::Framebuffer::blit(_fbo, GL::defaultFramebuffer, i32range2{{}, _size}, GL::FramebufferBlit::Color);
+	auto timing = _profiler.scope(_blitPass);
+	GL::Framebuffer::blit(_fbo, GL::defaultFramebuffer, i32range2{{}, _renderSize}, i32range2{{}, _size},
+	                      GL::FramebufferBlit::Color,
+	                      _renderSize == _size ? GL::FramebufferBlitFilter::Nearest : GL::FramebufferBlitFilter::Linear);
+}
+
+bool Scene::readColor(i32range2 const& rect, FrameReadback::Callback done)
+{
+	return _readback.read(_fbo, rect, PixelFormat::RGBA8Unorm, std::move(done));
+}
+
+bool Scene::readDepth(i32range2 const& rect, FrameReadback::Callback done)
+{
+	return _readback.read(_fbo, rect, PixelFormat::Depth32F, std::move(done));
+}
+
+void Scene::setAmbientColor(f32col3 const& color)
+{
+	_phongMaterial.setSubData(0, {Shaders::PhongMaterialUniform{}.setAmbientColor(color)});
+	_impostor.setAmbientColor(color);
+}
+
+void Scene::updateTransforms()
+{
+	_transforms.update(_reg, _jobs.get());
+	_spatial.update(_reg, _transforms);
+}
+
+void Scene::updateOrigin(const_handle cam)
+{
+	const f64vec3 position = cam.get<TransformComponent>().world_transform().translation();
+	if ((position - _transforms.origin()).length() > _rebaseDistance)
+	{
+		_transforms.setOrigin(_reg, position, _jobs.get());
+	}
 }
 
 void Scene::render(const_handle cam, bool isCamControl)
 {
+	updateTransforms();
+	updateOrigin(cam);
+	_readback.update();
+	_resolution.beginFrame();
 	renderScreens(cam, isCamControl);
 
-	_fbo.clearColor(0, f32col4{0.f, 0.f, 0.f, 0.f})
+	/* Scaling only moves the viewport, the targets never get reallocated */
+	_renderSize = _resolution.apply(_size);
+	_fbo.setViewport({{}, _renderSize})
+	    .clearColor(0, f32col4{0.f, 0.f, 0.f, 0.f})
 	    .clearDepth(0.f)
 	    .bind();
 
 	GL::Renderer::setDepthFunction(GL::Renderer::DepthFunction::Greater);
-	renderEntities(cam);
+	{
+		auto timing = _profiler.scope(_entitiesPass);
+		renderEntities(cam);
+	}
 	GL::Renderer::setDepthFunction(GL::Renderer::DepthFunction::Less);
+
+	_resolution.endFrame();
+	_transforms.endFrame();
 }
 
 void Scene::renderScreens(const_handle cam, bool isCamControl)
 {
+	auto timing = _profiler.scope(_screensPass);
 	GL::Renderer::disable(GL::Renderer::Feature::DepthTest);
 	GL::Renderer::enable(GL::Renderer::Feature::Blending);
 	GL::Renderer::enable(GL::Renderer::Feature::ScissorTest);
 	GL::Renderer::disable(GL::Renderer::Feature::FaceCulling);
 
+	auto const& camTransform = cam.get<TransformComponent>();
+	const Frustum frustum{viewProjection(cam)};
 	_reg.view<TransformComponent, ScreenComponent>().each(
-			[this, &cam, &isCamControl](entt::entity entity,
-			                            TransformComponent& transform,
-			                            ScreenComponent& screen)
+			[this, &cam, &camTransform, &isCamControl, &frustum](entt::entity entity,
+			                                                     TransformComponent& transform,
+			                                                     ScreenComponent& screen)
 			{
-				screen.context.processCamera(transform.world_transform(),
-				                             cam.get<TransformComponent>().world_transform(), isCamControl);
+				/* Nobody can see or point at an off-screen panel, its callback still runs but nothing gets drawn */
+				auto* mesh = _reg.try_get<MeshComponent>(entity);
+				const bool visible = !mesh || isVisible(frustum, transform, *mesh);
+
+				/* The cursor only moves when the screen, the camera or the control mode did */
+				if (visible && (screen.camera != cam.entity() || screen.cameraVersion != camTransform.version() ||
+				                screen.screenVersion != transform.version() || screen.cameraControl != isCamControl))
+				{
+					screen.context.processCamera(_transforms.relative(transform), _transforms.relative(camTransform),
+					                             isCamControl);
+					screen.camera = cam.entity();
+					screen.cameraVersion = camTransform.version();
+					screen.screenVersion = transform.version();
+					screen.cameraControl = isCamControl;
+				}
+
 				screen.context.newFrame();
 				ImGui::SetNextWindowPos(ImVec2(0, 0), ImGuiCond_Always);
 				ImGui::SetNextWindowSize(ImVec2{screen.context.size()}, ImGuiCond_Always);
@@ -133,6 +217,16 @@ void Scene::renderScreens(const_handle cam, bool isCamControl)
 				             ImGuiWindowFlags_NoSavedSettings);
 				screen.fn(entt::const_handle{_reg, entity});
 				ImGui::End();
+
+				if (!visible)
+				{
+					screen.context.endFrame();
+					return;
+				}
+
+				if (!screen.profilerPass)
+				{ screen.profilerPass = _profiler.pass("Screen: " + screen.title); }
+				auto drawTiming = _profiler.scope(*screen.profilerPass);
 				screen.context.drawFrame();
 			});
 
@@ -144,47 +238,336 @@ void Scene::renderScreens(const_handle cam, bool isCamControl)
 
 void Scene::renderEntities(const_handle cam)
 {
-	const f32mat4 view = cam.get<CameraComponent>().proj * cam.get<TransformComponent>().world_transform().toMatrix().invertedRigid();
-	_phong.setProjectionMatrix(view);
-	_pbr.setViewProjectionMatrix(view)
-	    .setCameraPosition(cam.get<TransformComponent>().world_transform().translation());
+	const f32mat4 view = viewProjection(cam);
+	f32mat4 const& camera = _transforms.matrix(cam.get<TransformComponent>());
+	const f32vec3 eye = camera.translation();
+	const Frustum frustum{view};
+
+	PhysicalShader::FrameUniform frame;
+	frame.viewProjection = view;
+	frame.cameraPosition = f32vec4{eye, 1.f};
+	frame.cameraForward = f32vec4{-camera.backward(), 0.f};
+	frame.clusterParameters = {f32vec2{_renderSize}, _lightClusters.nearDepth(), _lightClusters.sliceScale()};
+	frame.clusterSize = u32vec4{LightClusters::Size, 0};
+	_frameUniforms.setSubData(0, {frame});
+	updateLights(camera.invertedRigid(), cam.get<CameraComponent>().proj);
+
+	/* Projected diameter in pixels of a unit radius at unit distance */
+	const f32 pixelScale = cam.get<CameraComponent>().proj[1][1] * f32(_renderSize.y());
+
+	_visible.clear();
+	/* The tree only tests fattened boxes, the sphere test trims what slips through */
+	_spatial.queryFrustum(frustum, _transforms.origin(), _visible);
+
+	if (_occlusion.isEnabled())
+	{
+		_occluders.clear();
+		_reg.view<TransformComponent, OccluderComponent>().each(
+				[this](TransformComponent const& transform, OccluderComponent const& occluder)
+				{ _occluders.push_back({_transforms.matrix(transform), &occluder}); });
+		_occlusion.render(view, frustum, _occluders, _jobs.get());
+	}
+
+	_queue.clear();
+	for (auto entity: _visible)
+	{
+		auto [transform, mesh] = _reg.try_get<TransformComponent, MeshComponent>(entity);
+		if (!transform || !mesh || !mesh->gpu || !isVisible(frustum, *transform, *mesh))
+		{ continue; }
+
+		const f32vec3 center = _transforms.matrix(*transform).transformPoint(mesh->scaled_center());
+		if (_occlusion.isOccluded(center, mesh->scaled_radius()))
+		{ continue; }
+
+		const f32 depth = (center - eye).length();
+		/* Largest error, in world units, that projects within the LOD threshold at the nearest point of the bounds */
+		GpuMesh* gpu = mesh->lod_for(2.f * _lodThreshold * Math::max(depth - mesh->scaled_radius(), 0.f) / pixelScale);
+
+		auto* impostor = _reg.try_get<ImpostorComponent>(entity);
+		if (impostor && mesh->scaled_radius() * pixelScale < impostor->threshold * depth)
+		{
+			_queue.push(RenderQueue::Pass::Opaque, u8(DrawShader::Impostor), _billboard.get(), nullptr, depth, entity);
+			continue;
+		}
+
+		if (_reg.all_of<PhongMaterialComponent>(entity))
+		{ _queue.push(RenderQueue::Pass::Opaque, u8(DrawShader::Phong), gpu, nullptr, depth, entity); }
+		/* The library material rather than the component, so entities sharing it batch together */
+		if (auto* mat = _reg.try_get<PhysicalMaterialComponent>(entity))
+		{ _queue.push(RenderQueue::Pass::Opaque, u8(DrawShader::Physical), gpu, mat->material, depth, entity); }
+		if (auto* screen = _reg.try_get<ScreenComponent>(entity))
+		{ _queue.push(RenderQueue::Pass::Blended, u8(DrawShader::Flat), gpu, &screen->context.color(), depth, entity); }
+	}
+	queueTerrain(frustum, eye);
+	_queue.sort();
 
-	_reg.view<TransformComponent, MeshComponent, PhongMaterialComponent>().each(
-			[this](entt::entity entity,
-			       TransformComponent& transform,
-			       MeshComponent& mesh,
-			       PhongMaterialComponent& material)
+	span<RenderQueue::Item const> items = _queue.items();
+	_draws.clear();
+	for (std::size_t first = 0; first < items.size(); first = _queue.batchEnd(first))
+	{
+		if (DrawShader(items[first].shader) == DrawShader::Physical)
+		{
+			auto const* material = static_cast<PhysicalMaterial const*>(items[first].material);
+			_draws.emplace_back().material = {material->layer, bit_cast<u32>(material->emissivePower), 0, 0};
+		}
+	}
+	uploadDraws();
+
+	_instances.clear();
+	for (RenderQueue::Item const& item: items)
+	{
+		const f32mat4 model = instanceTransformation(item);
+
+		f32col4 color{1.f};
+		if (auto* material = _reg.try_get<PhongMaterialComponent>(item.entity);
+				material && DrawShader(item.shader) != DrawShader::Physical)
+		{ color = f32col4{material->diffuse, 1.f}; }
+
+		_instances.push_back({model, model.normalMatrix(), color, entt::to_integral(item.entity)});
+	}
+	uploadInstances();
+
+	if (_depthPrePass)
+	{
+		auto timing = _profiler.scope(_depthPass);
+		renderDepthPrePass();
+	}
+
+	/* Batches of a shader are contiguous within a queue pass, each run is timed as a whole */
+	optional<DrawShader> bound;
+	optional<u32> timing;
+	u32 draw = 0;
+	for (std::size_t first = 0, last; first < items.size(); first = last)
+	{
+		RenderQueue::Item const& batch = items[first];
+		last = _queue.batchEnd(first);
+
+		if (bound != DrawShader(batch.shader))
+		{
+			if (timing)
+			{ _profiler.end(*timing); }
+			bound = DrawShader(batch.shader);
+			timing = _profiler.begin(_shaderPasses[u8(*bound)]);
+			bindShaderBuffers(*bound);
+			if (_depthPrePass)
 			{
-				_phong.setTransformationMatrix(transform.world_transform().toMatrix())
-				      .setNormalMatrix(transform.transform.toMatrix().normalMatrix())
-				      .setDiffuseColor(material.diffuse)
-				      .setObjectId(entt::to_integral(entity))
-				      .draw(mesh.mesh);
-			});
+				GL::Renderer::setDepthFunction(isInDepthPrePass(*bound) ? GL::Renderer::DepthFunction::Equal
+				                                                        : GL::Renderer::DepthFunction::Greater);
+			}
+		}
+		if (*bound == DrawShader::Physical)
+		{ _pbr.setDrawOffset(draw++); }
 
-	_reg.view<TransformComponent, MeshComponent, PhysicalMaterialComponent>().each(
-			[this](entt::entity entity,
-			       TransformComponent& transform,
-			       MeshComponent& mesh,
-			       PhysicalMaterialComponent& mat)
+		drawInstanced(batch, first, last - first);
+	}
+	if (timing)
+	{ _profiler.end(*timing); }
+	GL::Renderer::setDepthFunction(GL::Renderer::DepthFunction::Greater);
+	GL::Renderer::disable(GL::Renderer::Feature::Blending);
+}
+
+void Scene::renderDepthPrePass()
+{
+	span<RenderQueue::Item const> items = _queue.items();
+
+	GL::Renderer::setColorMask(false, false, false, false);
+
+	optional<DrawShader> bound;
+	for (std::size_t first = 0, last; first < items.size(); first = last)
+	{
+		last = _queue.batchEnd(first);
+		const DrawShader shader = DrawShader(items[first].shader);
+		if (!isInDepthPrePass(shader))
+		{ continue; }
+
+		/* Binding for PhysicalShader binds for DepthShader too */
+		if (bound != shader)
+		{
+			bound = shader;
+			bindShaderBuffers(shader);
+		}
+
+		/* PhongGL has no depth-only variant, the same program with color writes off gives the same depth */
+		bindInstances(*items[first].mesh, first, last - first);
+		if (shader == DrawShader::Physical)
+		{ _pbrDepth.draw(items[first].mesh->mesh); }
+		else
+		{ _phong.draw(items[first].mesh->mesh); }
+	}
+
+	GL::Renderer::setColorMask(true, true, true, true);
+}
+
+void Scene::queueTerrain(Frustum const& frustum, f32vec3 const& eye)
+{
+	const f64vec3 camera = _transforms.origin() + f64vec3{eye};
+	_reg.view<TransformComponent, PlanetComponent>().each(
+			[this, &frustum, &eye, &camera](entt::entity entity, TransformComponent const& transform, PlanetComponent& planet)
 			{
-				_pbr.setModelMatrix(transform.world_transform().toMatrix())
-				    .bindTextures(&mat.albedo, &mat.normal, &mat.metallic, &mat.roughness, &mat.ambientOcclusion)
-				    .draw(mesh.mesh);
+				/* Refined in planet space, placed relative to the floating origin in double precision */
+				f64dquat const& world = transform.world_transform();
+				planet.terrain->update(world.invertedNormalized().transformPoint(camera), *_jobs, _terrainChunks);
+
+				for (PlanetTerrain::Chunk* chunk: _terrainChunks)
+				{
+					const f32vec3 center{world.transformPoint(chunk->center) - _transforms.origin()};
+					if (!frustum.intersectsSphere(center, chunk->radius) ||
+					    _occlusion.isOccluded(center, chunk->radius))
+					{ continue; }
+
+					_queue.push(RenderQueue::Pass::Opaque, u8(DrawShader::Terrain), &chunk->gpu, chunk,
+					            (center - eye).length(), entity);
+				}
 			});
+}
 
-	GL::Renderer::enable(GL::Renderer::Feature::Blending);
-	_reg.view<TransformComponent, MeshComponent, ScreenComponent>().each(
-			[this, &view](entt::entity entity,
-			             TransformComponent& transform,
-			             MeshComponent& mesh,
-			             ScreenComponent& screen)
+f32mat4 Scene::instanceTransformation(RenderQueue::Item const& item) const
+{
+	auto const& transform = _reg.get<TransformComponent>(item.entity);
+	if (DrawShader(item.shader) == DrawShader::Terrain)
+	{
+		f64dquat const& world = transform.world_transform();
+		auto const* chunk = static_cast<PlanetTerrain::Chunk const*>(item.material);
+		return f32mat4{f64mat4::from(world.rotation().toMatrix(),
+		                             world.transformPoint(chunk->center) - _transforms.origin())};
+	}
+
+	auto const& mesh = _reg.get<MeshComponent>(item.entity);
+	const f32mat4 model = _transforms.matrix(transform);
+	if (DrawShader(item.shader) == DrawShader::Impostor)
+	{
+		return f32mat4::translation(model.transformPoint(mesh.scaled_center())) *
+		       f32mat4::scaling(f32vec3{mesh.scaled_radius()});
+	}
+	if (mesh.scale != 1.f)
+	{ return model * f32mat4::scaling(f32vec3{mesh.scale}); }
+	return model;
+}
+
+void Scene::uploadDraws()
+{
+	if (_draws.empty())
+	{ return; }
+
+	/* Respecifying the whole store hands the driver fresh memory instead of synchronizing with the last frame */
+	_drawBuffer.setData(Containers::arrayView(_draws.data(), _draws.size()), GL::BufferUsage::StreamDraw);
+	_pbr.bindDrawBuffer(_drawBuffer, 0, _draws.size() * sizeof(PhysicalShader::DrawUniform));
+}
+
+void Scene::bindShaderBuffers(DrawShader shader)
+{
+	/* PhongGL and FlatGL3D use overlapping binding points, they get rebound whenever the shader changes */
+	switch (shader)
+	{
+		case DrawShader::Phong:
+		case DrawShader::Terrain:
+			_phong.bindProjectionBuffer(_frameUniforms)
+			      .bindTransformationBuffer(_identityTransformation)
+			      .bindDrawBuffer(_phongDraw)
+			      .bindMaterialBuffer(_phongMaterial)
+			      .bindLightBuffer(_phongLights);
+			break;
+		case DrawShader::Physical:
+			_pbr.bindFrameBuffer(_frameUniforms);
+			break;
+		case DrawShader::Impostor:
+			_pbr.bindFrameBuffer(_frameUniforms);
+			_impostor.bindLightBuffer(_phongLights);
+			break;
+		case DrawShader::Flat:
+			_flat.bindTransformationProjectionBuffer(_frameUniforms)
+			     .bindDrawBuffer(_flatDraw)
+			     .bindMaterialBuffer(_flatMaterial);
+			break;
+	}
+}
+
+void Scene::uploadInstances()
+{
+	if (!_instances.empty())
+	{ _instanceBuffer.setData(Containers::arrayView(_instances.data(), _instances.size()), GL::BufferUsage::StreamDraw); }
+}
+
+void Scene::bindInstances(GpuMesh& gpu, std::size_t first, std::size_t count)
+{
+	if (gpu.instanceBuffer != _instanceBuffer.id())
+	{
+		gpu.instanceBuffer = _instanceBuffer.id();
+		gpu.mesh.addVertexBufferInstanced(_instanceBuffer, 1, 0,
+		                                  Shaders::PhongGL::TransformationMatrix{},
+		                                  Shaders::PhongGL::NormalMatrix{},
+		                                  Shaders::PhongGL::Color4{},
+		                                  Shaders::PhongGL::ObjectId{});
+	}
+
+	gpu.mesh.setBaseInstance(u32(first))
+	        .setInstanceCount(i32(count));
+}
+
+void Scene::drawInstanced(RenderQueue::Item const& batch, std::size_t first, std::size_t count)
+{
+	GpuMesh& gpu = *batch.mesh;
+	bindInstances(gpu, first, count);
+
+	switch (DrawShader(batch.shader))
+	{
+		case DrawShader::Phong:
+		case DrawShader::Terrain:
+			_phong.draw(gpu.mesh);
+			break;
+		case DrawShader::Physical:
+		{
+			/* Rebinds nothing while materials stay on one page, the draw uniform selects the layer */
+			_materials.bind(static_cast<PhysicalMaterial const*>(batch.material)->page);
+			_pbr.draw(gpu.mesh);
+			break;
+		}
+		case DrawShader::Impostor:
+			_impostor.draw(gpu.mesh);
+			break;
+		case DrawShader::Flat:
+			GL::Renderer::enable(GL::Renderer::Feature::Blending);
+			_flat.bindTexture(_reg.get<ScreenComponent>(batch.entity).context.color())
+			     .draw(gpu.mesh);
+			break;
+	}
+}
+
+f32mat4 Scene::viewProjection(const_handle cam) const
+{
+	return cam.get<CameraComponent>().proj * _transforms.matrix(cam.get<TransformComponent>()).invertedRigid();
+}
+
+bool Scene::isVisible(Frustum const& frustum, TransformComponent const& transform, MeshComponent const& mesh) const
+{
+	return frustum.intersectsSphere(_transforms.matrix(transform).transformPoint(mesh.scaled_center()),
+	                               mesh.scaled_radius());
+}
+
+void Scene::updateLights(f32mat4 const& view, f32mat4 const& projection)
+{
+	_phongLightData.assign(_phong.lightCount(), Shaders::PhongLightUniform{}.setColor(f32col3{0.f}));
+	_pbrLights.clear();
+
+	u32 phongLight = 0;
+	_reg.view<TransformComponent, LightComponent>().each(
+			[this, &phongLight](TransformComponent& transform, LightComponent& light)
 			{
-				_flat.setTransformationProjectionMatrix(view * transform.world_transform().toMatrix())
-				     .bindTexture(screen.context.color())
-				     .draw(mesh.mesh);
+				const f32vec3 position = _transforms.matrix(transform).translation();
+				if (phongLight < _phongLightData.size())
+				{
+					_phongLightData[phongLight++].setPosition({position, 1.f})
+					                              .setColor(light.color)
+					                              .setRange(light.range);
+				}
+				_pbrLights.push_back({f32vec4{position, light.range}, f32vec4{light.color * light.intensity, 1.f}});
 			});
-	GL::Renderer::disable(GL::Renderer::Feature::Blending);
+
+	_phongLights.setSubData(0, Containers::arrayView(_phongLightData.data(), _phongLightData.size()));
+
+	_lightClusters.build(_pbrLights, view, projection);
+	_lightClusters.upload(PhysicalShader::LightBufferBinding, PhysicalShader::ClusterBufferBinding,
+	                      PhysicalShader::LightIndexBufferBinding);
 }
 
 entt::handle Scene::createEntity()
@@ -4,24 +4,125 @@
 #include <Magnum/Shaders/PhongGL.h>
 #include <Magnum/Shaders/FlatGL.h>
 #include <Magnum/GL/Texture.h>
+#include <Magnum/Shaders/Phong.h>
+#include <Magnum/GL/Buffer.h>
 
 #include <entt/entity/registry.hpp>
+#include <type_traits>
+#include <memory>
 
+#include "systems/TransformSystem.hpp"
 #include "shaders/PhysicalShader.hpp"
+#include "shaders/ImpostorShader.hpp"
+#include "shaders/DepthShader.hpp"
+#include "systems/SpatialIndex.hpp"
+#include "DynamicResolution.hpp"
+#include "FrameReadback.hpp"
+#include "MaterialLibrary.hpp"
+#include "OcclusionCuller.hpp"
+#include "LightClusters.hpp"
+#include "GpuProfiler.hpp"
+#include "PlanetTerrain.hpp"
+#include "RenderQueue.hpp"
 #include "Components.hpp"
+#include "MeshCache.hpp"
+#include "Frustum.hpp"
 #include "Types.hpp"
 
+namespace Implementation
+{
+	/* A spawn initializer is either a component prototype copied to every entity, or a function building the
+	 * component of the i-th entity */
+	template<class Init, class = void>
+	struct SpawnInitializer
+	{
+		using Type = Init;
+	};
+
+	template<class Init>
+	struct SpawnInitializer<Init, std::enable_if_t<std::is_invocable_v<Init const&, std::size_t>>>
+	{
+		using Type = std::decay_t<std::invoke_result_t<Init const&, std::size_t>>;
+	};
+}
+
 class Scene
 {
+	/* Per-instance attributes, laid out as PhongGL expects them; FlatGL3D and PhysicalShader only read the
+	 * transformation */
+	struct InstanceData
+	{
+		f32mat4 transformation;
+		f32mat3 normalMatrix;
+		f32col4 color;
+		u32 objectId;
+	};
+
+	enum class DrawShader : u8
+	{
+		Phong,
+		Physical,
+		Impostor,
+		Terrain,
+		Flat
+	};
+
 	Magnum::GL::Framebuffer _fbo{NoCreate};
 	Magnum::GL::Texture2D _color{NoCreate};
 	Magnum::GL::Texture2D _depth{NoCreate};
 	Magnum::Shaders::PhongGL _phong{NoCreate};
 	Magnum::Shaders::FlatGL3D _flat{NoCreate};
+	/* Linked program binaries of our own shaders, Magnum's built-in ones compile in their constructors */
+	ProgramBinaryCache _programs{};
 	PhysicalShader _pbr{NoCreate};
+	DepthShader _pbrDepth{NoCreate};
+	ImpostorShader _impostor{NoCreate};
+	/* Unit quad every impostor instance is drawn with */
+	std::shared_ptr<GpuMesh> _billboard{};
+
+	/* PhysicalShader::FrameUniform followed by the lights, its leading view-projection matrix doubles as the
+	 * projection of PhongGL and the transformation-projection of FlatGL3D */
+	Magnum::GL::Buffer _frameUniforms{NoCreate};
+	Magnum::GL::Buffer _phongLights{NoCreate};
+	Magnum::GL::Buffer _phongMaterial{NoCreate};
+	/* Never change, the per-instance attributes carry the transformations */
+	Magnum::GL::Buffer _identityTransformation{NoCreate};
+	Magnum::GL::Buffer _phongDraw{NoCreate};
+	Magnum::GL::Buffer _flatDraw{NoCreate};
+	Magnum::GL::Buffer _flatMaterial{NoCreate};
+	/* Per-draw PhysicalShader data, orphaned by every upload so it never waits on draws still reading it */
+	Magnum::GL::Buffer _drawBuffer{NoCreate};
+	/* InstanceData of every queued item in queue order, a batch draws from the base instance of its first item */
+	Magnum::GL::Buffer _instanceBuffer{NoCreate};
+	LightClusters _lightClusters{NoCreate};
+	DynamicResolution _resolution{NoCreate};
+	GpuProfiler _profiler{};
+	FrameReadback _readback{NoCreate};
+	/* Profiler ids of the scene passes, one per DrawShader for the batches */
+	u32 _screensPass{0}, _entitiesPass{0}, _depthPass{0}, _blitPass{0};
+	array<u32, 5> _shaderPasses{};
 
+	/* The targets are allocated at _size, frames only render to the lower left _renderSize of them */
 	i32vec2 _size{0, 0};
+	i32vec2 _renderSize{0, 0};
+	f64 _rebaseDistance{1024.0};
+	bool _depthPrePass{false};
+	f32 _lodThreshold{1.f};
 	entt::registry _reg{};
+	std::unique_ptr<ThreadPool> _jobs{};
+	MeshCache _meshes{};
+	MaterialLibrary _materials{};
+	TransformSystem _transforms{};
+	SpatialIndex _spatial{};
+	OcclusionCuller _occlusion{};
+	vector<OcclusionCuller::Occluder> _occluders{};
+	vector<entt::entity> _visible{};
+	RenderQueue _queue{};
+	vector<InstanceData> _instances{};
+	vector<PlanetTerrain::Chunk*> _terrainChunks{};
+	vector<PhysicalShader::DrawUniform> _draws{};
+	vector<LightClusters::Light> _pbrLights{};
+	vector<Magnum::Shaders::PhongLightUniform> _phongLightData{};
 
 public:
 	static f32mat4 createReverseProjectionMatrix(f32rad fov, f32 aspectRation, f32 near);
@@ -41,15 +142,82 @@ public:
 
 	Scene& operator=(Scene&&) noexcept = default;
 
+	/* lightCount only bounds the PhongGL lights, PhysicalShader shades any number of them through LightClusters */
 	void create(i32vec2 const& size, u32 lightCount = 1);
 
+	/* Upscales the rendered part of the color target to the whole default framebuffer */
 	void blitToDefaultFramebuffer();
 
+	void setAmbientColor(f32col3 const& color);
+
+	void updateTransforms();
+
+	/* How far the camera may drift from the floating origin before rendering rebases on it, 0 rebases every frame */
+	void setRebaseDistance(f64 distance)
+	{ _rebaseDistance = distance; }
+
+	[[nodiscard]] f64vec3 const& origin() const
+	{ return _transforms.origin(); }
+
+	/* Lays down the depth of the opaque PhongGL and PhysicalShader geometry first, so the expensive PBR shading only
+	 * runs on the pixels that end up visible */
+	void setDepthPrePass(bool enabled)
+	{ _depthPrePass = enabled; }
+
+	[[nodiscard]] bool depthPrePass() const
+	{ return _depthPrePass; }
+
+	/* Screen-space error in pixels a MeshComponent level of detail may show before a finer one gets drawn */
+	void setLodThreshold(f32 pixels)
+	{ _lodThreshold = pixels; }
+
 	void render(entt::const_handle cam, bool isCamControl);
 
+	/* Asynchronous copies of rect of the color or depth target, done gets the image a few frames later from render().
+	 * The depth is reversed, 1 on the near plane. False when too many reads are in flight. */
+	bool readColor(i32range2 const& rect, FrameReadback::Callback done);
+
+	bool readDepth(i32range2 const& rect, FrameReadback::Callback done);
+
 	auto& registry()
 	{ return _reg; }
 
+	auto& jobs()
+	{ return *_jobs; }
+
+	auto const& transforms() const
+	{ return _transforms; }
+
+	auto const& spatial() const
+	{ return _spatial; }
+
+	auto& meshes()
+	{ return _meshes; }
+
+	auto& materials()
+	{ return _materials; }
+
+	/* Hides entities behind the OccluderComponent shapes before they get queued */
+	auto& occlusion()
+	{ return _occlusion; }
+
+	auto& lightClusters()
+	{ return _lightClusters; }
+
+	auto& resolution()
+	{ return _resolution; }
+
+	/* GPU time of every render pass, the application brackets its frames with beginFrame() and endFrame() */
+	auto& profiler()
+	{ return _profiler; }
+
+	/* Also reads any other framebuffer, like ScreenImContext::framebuffer() */
+	auto& readback()
+	{ return _readback; }
+
+	[[nodiscard]] i32vec2 const& renderSize() const
+	{ return _renderSize; }
+
 	auto& phongShader()
 	{ return _phong; }
 
@@ -67,8 +235,73 @@ public:
 
 	entt::handle createEntity();
 
+	/* Creates count entities with one range insertion per component type and returns them in creation order.
+	 * Each initializer is a component prototype or a callable taking the entity index and returning a component;
+	 * a TransformComponent is added with default values unless one of the initializers provides it. */
+	template<class... Inits>
+	vector<entt::entity> createEntities(std::size_t count, Inits const& ... inits)
+	{
+		vector<entt::entity> ret(count);
+		_reg.create(ret.begin(), ret.end());
+
+		if constexpr (!(std::is_same_v<typename Implementation::SpawnInitializer<Inits>::Type, TransformComponent> || ...))
+		{ _reg.insert<TransformComponent>(ret.begin(), ret.end()); }
+		(insertComponents(ret, inits), ...);
+
+		return ret;
+	}
+
 private:
+	template<class Init>
+	void insertComponents(vector<entt::entity> const& entities, Init const& init)
+	{
+		using Type = typename Implementation::SpawnInitializer<Init>::Type;
+
+		if constexpr (std::is_invocable_v<Init const&, std::size_t>)
+		{
+			vector<Type> components;
+			components.reserve(entities.size());
+			for (std::size_t i = 0; i < entities.size(); ++i)
+			{ components.push_back(init(i)); }
+			_reg.insert<Type>(entities.begin(), entities.end(), components.begin());
+		}
+		else
+		{
+			_reg.insert<Type>(entities.begin(), entities.end(), init);
+		}
+	}
+
+	void updateOrigin(entt::const_handle cam);
+
+	[[nodiscard]] f32mat4 viewProjection(entt::const_handle cam) const;
+
+	[[nodiscard]] bool isVisible(Frustum const& frustum, TransformComponent const& transform,
+	                             MeshComponent const& mesh) const;
+
+	void updateLights(f32mat4 const& view, f32mat4 const& projection);
+
 	void renderScreens(entt::const_handle cam, bool isCamControl);
 
 	void renderEntities(entt::const_handle cam);
+
+	void queueTerrain(Frustum const& frustum, f32vec3 const& eye);
+
+	[[nodiscard]] f32mat4 instanceTransformation(RenderQueue::Item const& item) const;
+
+	void uploadDraws();
+
+	void uploadInstances();
+
+	void renderDepthPrePass();
+
+	/* Drawn to the pre-pass with the program of the shading pass or one reproducing its depth exactly, then shaded
+	 * with an Equal depth test */
+	[[nodiscard]] static bool isInDepthPrePass(DrawShader shader)
+	{ return shader == DrawShader::Phong || shader == DrawShader::Terrain || shader == DrawShader::Physical; }
+
+	void bindShaderBuffers(DrawShader shader);
+
+	void bindInstances(GpuMesh& gpu, std::size_t first, std::size_t count);
+
+	void drawInstanced(RenderQueue::Item const& batch, std::size_t first, std::size_t count);
 };
@@ -1,5 +1,4 @@
 #include <Magnum/MeshTools/Transform.h>
-#include <Magnum/MeshTools/Compile.h>
 #include <Magnum/Primitives/Plane.h>
 #include <Magnum/Trade/MeshData.h>
 #include <Magnum/MeshTools/Copy.h>
@@ -21,14 +20,15 @@ void PlayerShip::create(Scene& scene)
 {
 	_root = scene.createEntity();
 
+	/* The screens only differ by their UI texture, they all share one plane */
+	const MeshComponent plane = scene.meshes().planeSolid(Primitives::PlaneFlag::TextureCoordinates);
+
 	_center_screen = scene.createEntity();
 	_center_screen.get<TransformComponent>()
 	              .set_parent(_root)
 	              .apply_transform(f32dquat::translation(f32vec3{0.f, 1.8f, 0.f}) *
 	                               f32dquat::rotation(-30.0_degf, f32vec3::xAxis()));
-	_center_screen.emplace<MeshComponent>(
-			[](GL::Mesh* mesh)
-			{ *mesh = MeshTools::compile(Primitives::planeSolid(Primitives::PlaneFlag::TextureCoordinates)); });
+	_center_screen.emplace<MeshComponent>(plane);
 	_center_screen.emplace<ScreenComponent>("Main Screen", i32vec2{512, 512})
 	              .set_function([this](entt::const_handle entity)
 	                            { process_center_screen(entity); });
@@ -39,9 +39,7 @@ void PlayerShip::create(Scene& scene)
 	            .apply_transform(f32dquat::translation(f32vec3{-2.5f, 2.1f, .5f}) *
 	                             f32dquat::rotation(-30.0_degf, f32vec3::xAxis()) *
 			                             f32dquat::rotation(30.0_degf, f32vec3::yAxis()));
-	_left_screen.emplace<MeshComponent>(
-			[](GL::Mesh* mesh)
-			{ *mesh = MeshTools::compile(Primitives::planeSolid(Primitives::PlaneFlag::TextureCoordinates)); });
+	_left_screen.emplace<MeshComponent>(plane);
 	_left_screen.emplace<ScreenComponent>("Left Screen", i32vec2{512, 512})
 	            .set_function([this](entt::const_handle entity)
 	                          { process_left_screen(entity); });
@@ -52,9 +50,7 @@ void PlayerShip::create(Scene& scene)
 	             .apply_transform(f32dquat::translation(f32vec3{2.5f, 2.1f, .5f}) *
 	                              f32dquat::rotation(-30.0_degf, f32vec3::xAxis()) *
 	                              f32dquat::rotation(-30.0_degf, f32vec3::yAxis()));
-	_right_screen.emplace<MeshComponent>(
-			[](GL::Mesh* mesh)
-			{ *mesh = MeshTools::compile(Primitives::planeSolid(Primitives::PlaneFlag::TextureCoordinates)); });
+	_right_screen.emplace<MeshComponent>(plane);
 	_right_screen.emplace<ScreenComponent>("Right Screen", i32vec2{512, 512})
 	             .set_function([this](entt::const_handle entity)
 	                           { process_right_screen(entity); });
@@ -0,0 +1,19 @@
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/Resource.h>
+#include <Magnum/GL/Shader.h>
+
+#include "DepthShader.hpp"
+
+using namespace Magnum;
+
+DepthShader::DepthShader(PhysicalShader::Flags flags, ProgramBinaryCache const* cache)
+{
+	Utility::Resource rs("AsteropeShaders");
+
+	const ProgramBinaryCache::Stage stages[]{
+			{GL::Shader::Type::Vertex, {rs.getString("generic.glsl"), PhysicalShader::bindingDefines(),
+			                            flags & PhysicalShader::Flag::InstancedTransformation
+			                            ? "#define INSTANCED_TRANSFORMATION\n" : "",
+			                            rs.getString("pbr.uniforms.glsl"), rs.getString("depth.vert.glsl")}}};
+	ProgramBinaryCache::loadOrBuild(cache, *this, stages);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "PhysicalShader.hpp"
+#include "../../Types.hpp"
+
+/* Position-only counterpart of PhysicalShader for the depth pre-pass, a vertex stage and no fragment stage. It reads
+ * the same frame buffer through the same binding point, binding it for PhysicalShader binds it here. */
+class DepthShader : public Magnum::GL::AbstractShaderProgram
+{
+public:
+	using Position = Magnum::Shaders::GenericGL3D::Position;
+	using TransformationMatrix = Magnum::Shaders::GenericGL3D::TransformationMatrix;
+
+	explicit DepthShader(PhysicalShader::Flags flags = {}, ProgramBinaryCache const* cache = nullptr);
+
+	explicit DepthShader(NoCreateT) noexcept: Magnum::GL::AbstractShaderProgram(NoCreate)
+	{}
+
+	DepthShader(DepthShader const&) = delete;
+
+	DepthShader& operator=(DepthShader const&) = delete;
+
+	DepthShader(DepthShader&&) noexcept = default;
+
+	DepthShader& operator=(DepthShader&&) noexcept = default;
+};
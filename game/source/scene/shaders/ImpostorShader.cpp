@@ -0,0 +1,37 @@
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/FormatStl.h>
+#include <Corrade/Utility/Resource.h>
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/Shader.h>
+
+#include "ImpostorShader.hpp"
+
+using namespace Magnum;
+
+ImpostorShader::ImpostorShader(ProgramBinaryCache const* cache)
+{
+	Utility::Resource rs("AsteropeShaders");
+
+	const string defines = PhysicalShader::bindingDefines() +
+	                       Utility::formatString("#define PHONG_LIGHT_BUFFER_BINDING {}\n", PhongLightBufferBinding);
+	const ProgramBinaryCache::Stage stages[]{
+			{GL::Shader::Type::Vertex, {rs.getString("generic.glsl"), defines, rs.getString("pbr.uniforms.glsl"),
+			                            rs.getString("impostor.vert.glsl")}},
+			{GL::Shader::Type::Fragment, {defines, rs.getString("pbr.uniforms.glsl"),
+			                              rs.getString("impostor.frag.glsl")}}};
+	ProgramBinaryCache::loadOrBuild(cache, *this, stages);
+
+	setAmbientColor(f32col3{0.f});
+}
+
+ImpostorShader& ImpostorShader::setAmbientColor(f32col3 const& color)
+{
+	setUniform(_ambientColorLocation, color);
+	return *this;
+}
+
+ImpostorShader& ImpostorShader::bindLightBuffer(GL::Buffer& buffer)
+{
+	buffer.bind(GL::Buffer::Target::ShaderStorage, PhongLightBufferBinding);
+	return *this;
+}
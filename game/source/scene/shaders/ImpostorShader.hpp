@@ -0,0 +1,39 @@
+#pragma once
+
+#include "PhysicalShader.hpp"
+#include "../../Types.hpp"
+
+/* Camera-facing quad per instance, ray traced against the sphere in the fragment shader. The instanced transformation
+ * is a translation to the sphere center scaled by its radius, the instanced color its diffuse color. Reads the frame
+ * buffer through the PhysicalShader binding points and shades like the PhongGL it stands in for, from the same light
+ * buffer and ambient color. */
+class ImpostorShader : public Magnum::GL::AbstractShaderProgram
+{
+public:
+	using Position = Magnum::Shaders::GenericGL3D::Position;
+	using TransformationMatrix = Magnum::Shaders::GenericGL3D::TransformationMatrix;
+	using Color4 = Magnum::Shaders::GenericGL3D::Color4;
+
+	/* Shader storage binding of the PhongLightUniform array, past the PhysicalShader ones */
+	static constexpr u32 PhongLightBufferBinding = 4;
+
+	explicit ImpostorShader(ProgramBinaryCache const* cache = nullptr);
+
+	explicit ImpostorShader(NoCreateT) noexcept: Magnum::GL::AbstractShaderProgram(NoCreate)
+	{}
+
+	ImpostorShader(ImpostorShader const&) = delete;
+
+	ImpostorShader& operator=(ImpostorShader const&) = delete;
+
+	ImpostorShader(ImpostorShader&&) noexcept = default;
+
+	ImpostorShader& operator=(ImpostorShader&&) noexcept = default;
+
+	ImpostorShader& setAmbientColor(f32col3 const& color);
+
+	ImpostorShader& bindLightBuffer(Magnum::GL::Buffer& buffer);
+
+private:
+	i32 _ambientColorLocation{1};
+};
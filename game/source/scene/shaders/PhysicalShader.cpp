@@ -1,79 +1,54 @@
-#include <Corrade/Containers/Reference.h>
+#include <Corrade/Containers/StringStl.h>
 #include <Corrade/Utility/FormatStl.h>
 #include <Corrade/Utility/Resource.h>
-#include <Magnum/GL/Texture.h>
-#include <Magnum/GL/Version.h>
+#include <Magnum/GL/Buffer.h>
 #include <Magnum/GL/Shader.h>
 
 #include "PhysicalShader.hpp"
 
 using namespace Magnum;
 
-PhysicalShader::PhysicalShader(u32 lightCount)
-		: _lightCount{lightCount}, _lightColorsLocation{_lightPositionsLocation + (i32) lightCount}
+string PhysicalShader::bindingDefines()
 {
-	Utility::Resource rs("AsteropeShaders");
-
-	GL::Shader vert{GL::Version::GL450, GL::Shader::Type::Vertex}, frag{GL::Version::GL450, GL::Shader::Type::Fragment};
-
-	vert.addSource(rs.getString("generic.glsl"))
-	    .addSource(rs.getString("pbr.vert.glsl"));
-	frag.addSource(Utility::formatString("#define LIGHT_COUNT {}\n", _lightCount).c_str())
-	    .addSource(Utility::formatString("#define LIGHT_COLORS_LOCATION {}\n", _lightColorsLocation).c_str())
-	    .addSource(rs.getString("pbr.frag.glsl"));
-
-	CORRADE_INTERNAL_ASSERT_OUTPUT(vert.compile() && frag.compile());
-	attachShader(vert);
-	attachShader(frag);
-	CORRADE_INTERNAL_ASSERT_OUTPUT(link());
-
-	setEmissivePower(0.f);
+	return Utility::formatString("#define FRAME_BUFFER_BINDING {}\n"
+	                             "#define DRAW_BUFFER_BINDING {}\n"
+	                             "#define LIGHT_BUFFER_BINDING {}\n"
+	                             "#define CLUSTER_BUFFER_BINDING {}\n"
+	                             "#define LIGHT_INDEX_BUFFER_BINDING {}\n",
+	                             FrameBufferBinding, DrawBufferBinding, LightBufferBinding,
+	                             ClusterBufferBinding, LightIndexBufferBinding);
 }
 
-PhysicalShader& PhysicalShader::setViewProjectionMatrix(const f32mat4& viewProj)
+PhysicalShader::PhysicalShader(Flags flags, ProgramBinaryCache const* cache) : _flags{flags}
 {
-	setUniform(_viewProjMatrixLocation, viewProj);
-	return *this;
-}
+	Utility::Resource rs("AsteropeShaders");
 
-PhysicalShader& PhysicalShader::setModelMatrix(const f32mat4& model)
-{
-	setUniform(_modelMatrixLocation, model);
-	return *this;
-}
+	const string defines = bindingDefines();
+	const ProgramBinaryCache::Stage stages[]{
+			{GL::Shader::Type::Vertex, {rs.getString("generic.glsl"), defines,
+			                            flags & Flag::InstancedTransformation
+			                            ? "#define INSTANCED_TRANSFORMATION\n" : "",
+			                            rs.getString("pbr.uniforms.glsl"), rs.getString("pbr.vert.glsl")}},
+			{GL::Shader::Type::Fragment, {defines, rs.getString("pbr.uniforms.glsl"), rs.getString("pbr.frag.glsl")}}};
+	ProgramBinaryCache::loadOrBuild(cache, *this, stages);
 
-PhysicalShader& PhysicalShader::setCameraPosition(const f32vec3& position)
-{
-	setUniform(_camPositionLocation, position);
-	return *this;
+	setDrawOffset(0);
 }
 
-PhysicalShader& PhysicalShader::setEmissivePower(f32 power)
+PhysicalShader& PhysicalShader::bindFrameBuffer(GL::Buffer& buffer)
 {
-	setUniform(_emissivePowerLocation, power);
+	buffer.bind(GL::Buffer::Target::Uniform, FrameBufferBinding);
 	return *this;
 }
 
-PhysicalShader& PhysicalShader::setLightParameters(u32 index, const f32vec3& position, f32col3 const& color)
+PhysicalShader& PhysicalShader::bindDrawBuffer(GL::Buffer& buffer, std::size_t offset, std::size_t size)
 {
-	CORRADE_ASSERT(index < _lightCount, "PhysicalShader::setLightParameters(): light ID"
-			<< index
-			<< "is out of bounds for"
-			<< _lightCount
-			<< "lights", *this);
-
-	setUniform(_lightPositionsLocation + (i32) index, position);
-	setUniform(_lightColorsLocation + (i32) index, color);
+	buffer.bind(GL::Buffer::Target::ShaderStorage, DrawBufferBinding, GLintptr(offset), GLsizeiptr(size));
 	return *this;
 }
 
-PhysicalShader& PhysicalShader::bindTextures(GL::Texture2D* albedo,
-                                             GL::Texture2D* normal,
-                                             GL::Texture2D* metallic,
-                                             GL::Texture2D* roughness,
-                                             GL::Texture2D* ambientOcclusion,
-                                             GL::Texture2D* emissive)
+PhysicalShader& PhysicalShader::setDrawOffset(u32 offset)
 {
-	GL::AbstractTexture::bind(0, {albedo, normal, metallic, roughness, ambientOcclusion, emissive});
+	setUniform(_drawOffsetLocation, offset);
 	return *this;
 }
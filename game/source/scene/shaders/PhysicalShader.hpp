@@ -1,22 +1,63 @@
 #pragma once
 
 #include <Magnum/GL/AbstractShaderProgram.h>
+#include <Corrade/Containers/EnumSet.h>
 #include <Magnum/Shaders/GenericGL.h>
 
+#include "ProgramBinaryCache.hpp"
 #include "../../Types.hpp"
 
+/* Cook-Torrance PBR shader. The camera comes from a per-frame uniform buffer bound once, per-draw data from a
+ * shader storage buffer indexed by setDrawOffset(). Lights are read from the LightClusters buffers, every fragment
+ * only shades the lights binned into its cluster. */
 class PhysicalShader : public Magnum::GL::AbstractShaderProgram
 {
 public:
 	using TextureCoordinates = Magnum::Shaders::GenericGL3D::TextureCoordinates;
 	using Position = Magnum::Shaders::GenericGL3D::Position;
 	using Normal = Magnum::Shaders::GenericGL3D::Normal;
-
-	explicit PhysicalShader(u32 lightCount = 1);
+	using TransformationMatrix = Magnum::Shaders::GenericGL3D::TransformationMatrix;
+
+	enum class Flag : u8
+	{
+		/* Transforms by the per-instance TransformationMatrix attribute, positions are in world space otherwise */
+		InstancedTransformation = 1 << 0
+	};
+
+	using Flags = Corrade::Containers::EnumSet<Flag>;
+
+	/* std140 layout of the per-frame buffer */
+	struct FrameUniform
+	{
+		f32mat4 viewProjection{IdentityInit};
+		f32vec4 cameraPosition{};
+		f32vec4 cameraForward{};
+		/* xy is the viewport size, z the LightClusters near depth and w its slice scale */
+		f32vec4 clusterParameters{};
+		u32vec4 clusterSize{};
+	};
+
+	/* std430 element of the per-draw buffer */
+	struct DrawUniform
+	{
+		/* x is the layer of the material in the bound MaterialLibrary page, y the bits of its emissive power */
+		u32vec4 material{};
+	};
+
+	static constexpr u32 FrameBufferBinding = 0;
+	static constexpr u32 DrawBufferBinding = 0;
+	static constexpr u32 LightBufferBinding = 1;
+	static constexpr u32 ClusterBufferBinding = 2;
+	static constexpr u32 LightIndexBufferBinding = 3;
+
+	/* Binding points of pbr.uniforms.glsl, for every shader including it */
+	[[nodiscard]] static string bindingDefines();
+
+	/* With a cache the linked program is loaded from, or stored to, disk instead of always being compiled */
+	explicit PhysicalShader(Flags flags = {}, ProgramBinaryCache const* cache = nullptr);
 
 	explicit PhysicalShader(NoCreateT) noexcept
-			: Magnum::GL::AbstractShaderProgram(NoCreate), _lightCount{1},
-			  _lightColorsLocation{_lightPositionsLocation + 1}
+			: Magnum::GL::AbstractShaderProgram(NoCreate), _flags{}
 	{}
 
 	PhysicalShader(PhysicalShader const&) = delete;
@@ -27,32 +68,19 @@ public:
 
 	PhysicalShader& operator=(PhysicalShader&&) noexcept = default;
 
-	[[nodiscard]] u32 lightCount() const
-	{ return _lightCount; }
-
-	PhysicalShader& setViewProjectionMatrix(f32mat4 const& viewProj);
-
-	PhysicalShader& setModelMatrix(f32mat4 const& model);
+	[[nodiscard]] Flags flags() const
+	{ return _flags; }
 
-	PhysicalShader& setCameraPosition(f32vec3 const& position);
+	PhysicalShader& bindFrameBuffer(Magnum::GL::Buffer& buffer);
 
-	PhysicalShader& setEmissivePower(f32 power);
+	PhysicalShader& bindDrawBuffer(Magnum::GL::Buffer& buffer, std::size_t offset, std::size_t size);
 
-	PhysicalShader& setLightParameters(u32 index, f32vec3 const& position, f32col3 const& color);
-
-	PhysicalShader& bindTextures(Magnum::GL::Texture2D* albedo,
-	                             Magnum::GL::Texture2D* normal,
-	                             Magnum::GL::Texture2D* metallic,
-	                             Magnum::GL::Texture2D* roughness,
-	                             Magnum::GL::Texture2D* ambientOcclusion = nullptr,
-	                             Magnum::GL::Texture2D* emissive = nullptr);
+	/* Index of the DrawUniform used by the next draws, relative to the bound range */
+	PhysicalShader& setDrawOffset(u32 offset);
 
 private:
-	u32 _lightCount;
-	i32 _viewProjMatrixLocation{0},
-			_modelMatrixLocation{1},
-			_camPositionLocation{2},
-			_emissivePowerLocation{3},
-			_lightPositionsLocation{10},
-			_lightColorsLocation;
+	Flags _flags;
+	i32 _drawOffsetLocation{0};
 };
+
+CORRADE_ENUMSET_OPERATORS(PhysicalShader::Flags)
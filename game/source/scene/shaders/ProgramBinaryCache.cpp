@@ -0,0 +1,176 @@
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/FormatStl.h>
+#include <Magnum/GL/Extensions.h>
+#include <Magnum/GL/Context.h>
+#include <Magnum/GL/Version.h>
+#include <Magnum/GL/OpenGL.h>
+#include <algorithm>
+#include <fstream>
+
+#include "ProgramBinaryCache.hpp"
+
+using namespace Magnum;
+
+static constexpr u32 Magic = 0x32425041; /* "APB2" */
+
+static std::filesystem::path entryPath(std::filesystem::path const& directory, ProgramBinaryCache::Key const& key)
+{
+	return directory / Utility::formatString("{:.16x}.bin", key.hash);
+}
+
+/* FNV-1a, the same on every run and every platform */
+static void fnv1a(u64& hash, void const* data, std::size_t size)
+{
+	auto const* bytes = static_cast<unsigned char const*>(data);
+	for (std::size_t i = 0; i < size; ++i)
+	{ hash = (hash ^ bytes[i]) * 0x100000001b3ull; }
+}
+
+ProgramBinaryCache::ProgramBinaryCache(std::filesystem::path directory) : _directory{std::move(directory)}
+{
+	GLint formats = 0;
+	if (GL::Context::current().isExtensionSupported<GL::Extensions::ARB::get_program_binary>())
+	{ glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats); }
+
+	std::error_code error;
+	std::filesystem::create_directories(_directory, error);
+	_supported = formats > 0 && !error;
+	if (!_supported)
+	{ Warning{} << "ProgramBinaryCache: program binaries unavailable, shaders will always be compiled"; }
+}
+
+ProgramBinaryCache::Key ProgramBinaryCache::key(span<Stage const> stages)
+{
+	GL::Context& context = GL::Context::current();
+
+	Key key{0xcbf29ce484222325ull, 0x84222325cbf29ce4ull, 0};
+	auto add = [&key](string_view part)
+	{
+		/* Length first, so moving text from one part to the next changes the key */
+		const u64 size = part.size();
+		for (u64* hash: {&key.hash, &key.check})
+		{
+			fnv1a(*hash, &size, sizeof(size));
+			fnv1a(*hash, part.data(), part.size());
+		}
+		key.length += sizeof(size) + size;
+	};
+
+	add(string{context.vendorString()});
+	add(string{context.rendererString()});
+	add(string{context.versionString()});
+	for (Stage const& stage: stages)
+	{
+		add(string_view{reinterpret_cast<char const*>(&stage.type), sizeof(stage.type)});
+		for (string const& source: stage.sources)
+		{ add(source); }
+	}
+	return key;
+}
+
+bool ProgramBinaryCache::loadOrBuild(ProgramBinaryCache const* cache, GL::AbstractShaderProgram& program,
+                                     span<Stage const> stages)
+{
+	Key key{};
+	if (cache)
+	{
+		key = ProgramBinaryCache::key(stages);
+		if (cache->load(program, key))
+		{ return true; }
+	}
+
+	/* Attaching and linking are protected in AbstractShaderProgram, they go through GL directly like the binaries */
+	vector<GL::Shader> shaders;
+	shaders.reserve(stages.size());
+	for (Stage const& stage: stages)
+	{
+		GL::Shader& shader = shaders.emplace_back(GL::Version::GL450, stage.type);
+		for (string const& source: stage.sources)
+		{ shader.addSource(source); }
+		CORRADE_INTERNAL_ASSERT_OUTPUT(shader.compile());
+		glAttachShader(program.id(), shader.id());
+	}
+
+	if (cache)
+	{ cache->prepare(program); }
+	glLinkProgram(program.id());
+
+	GLint linked = GL_FALSE, logLength = 0;
+	glGetProgramiv(program.id(), GL_LINK_STATUS, &linked);
+	if (linked != GL_TRUE)
+	{
+		glGetProgramiv(program.id(), GL_INFO_LOG_LENGTH, &logLength);
+		string log(std::size_t(std::max(logLength, 1)), '\0');
+		glGetProgramInfoLog(program.id(), GLsizei(log.size()), nullptr, log.data());
+		Fatal{} << "ProgramBinaryCache: linking failed:" << log.c_str();
+		std::exit(1);
+	}
+
+	for (GL::Shader const& shader: shaders)
+	{ glDetachShader(program.id(), shader.id()); }
+	if (cache)
+	{ cache->store(program, key); }
+	return false;
+}
+
+bool ProgramBinaryCache::load(GL::AbstractShaderProgram& program, Key const& key) const
+{
+	if (!_supported)
+	{ return false; }
+
+	std::ifstream file{entryPath(_directory, key), std::ios::binary | std::ios::ate};
+	if (!file)
+	{ return false; }
+
+	const auto size = std::size_t(file.tellg());
+	u32 magic = 0, format = 0;
+	Key stored{};
+	if (size <= sizeof(magic) + sizeof(format) + sizeof(stored))
+	{ return false; }
+
+	vector<char> binary(size - sizeof(magic) - sizeof(format) - sizeof(stored));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(&magic), sizeof(magic))
+	    .read(reinterpret_cast<char*>(&format), sizeof(format))
+	    .read(reinterpret_cast<char*>(&stored), sizeof(stored))
+	    .read(binary.data(), std::streamsize(binary.size()));
+	/* Another program whose hash collided, or a stale entry */
+	if (!file || magic != Magic || stored != key)
+	{ return false; }
+
+	glProgramBinary(program.id(), GLenum(format), binary.data(), GLsizei(binary.size()));
+
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program.id(), GL_LINK_STATUS, &linked);
+	return linked == GL_TRUE;
+}
+
+void ProgramBinaryCache::prepare(GL::AbstractShaderProgram& program) const
+{
+	if (_supported)
+	{ glProgramParameteri(program.id(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); }
+}
+
+void ProgramBinaryCache::store(GL::AbstractShaderProgram const& program, Key const& key) const
+{
+	if (!_supported)
+	{ return; }
+
+	GLint length = 0;
+	glGetProgramiv(program.id(), GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+	{ return; }
+
+	vector<char> binary(std::size_t(length), 0);
+	GLenum format = 0;
+	glGetProgramBinary(program.id(), length, &length, &format, binary.data());
+
+	const u32 magic = Magic, storedFormat = format;
+	std::ofstream file{entryPath(_directory, key), std::ios::binary | std::ios::trunc};
+	file.write(reinterpret_cast<char const*>(&magic), sizeof(magic))
+	    .write(reinterpret_cast<char const*>(&storedFormat), sizeof(storedFormat))
+	    .write(reinterpret_cast<char const*>(&key), sizeof(key))
+	    .write(binary.data(), length);
+	if (!file)
+	{ Warning{} << "ProgramBinaryCache: could not write" << entryPath(_directory, key).string(); }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Magnum/GL/AbstractShaderProgram.h>
+#include <Magnum/GL/Shader.h>
+#include <filesystem>
+
+#include "../../Types.hpp"
+
+/* On-disk cache of linked program binaries (ARB_get_program_binary). Entries are keyed by a hash of the complete
+ * shader sources, defines included, and of the GL vendor, renderer and version strings, so a driver update or a
+ * changed define simply misses. The hashes are FNV-1a, stable across runs unlike std::hash; every entry stores its
+ * whole key, so a file name collision is a miss too. A binary the driver rejects falls back to compiling. */
+class ProgramBinaryCache
+{
+	std::filesystem::path _directory{};
+	bool _supported{false};
+
+public:
+	ProgramBinaryCache() = default;
+
+	/* Needs a current GL context */
+	explicit ProgramBinaryCache(std::filesystem::path directory);
+
+	[[nodiscard]] bool isSupported() const
+	{ return _supported; }
+
+	/* Sources of one shader of a program, in the order they are handed to it */
+	struct Stage
+	{
+		Magnum::GL::Shader::Type type;
+		vector<string> sources;
+	};
+
+	struct Key
+	{
+		/* Names the entry file */
+		u64 hash;
+		/* Second hash, with another basis, and the byte count of everything hashed */
+		u64 check;
+		u64 length;
+
+		bool operator==(Key const&) const = default;
+	};
+
+	/* Links program from the binary cache holds for stages, or compiles and links stages and stores the result. Without
+	 * a cache it only compiles, the key is not even computed. True when the binary was loaded. */
+	static bool loadOrBuild(ProgramBinaryCache const* cache, Magnum::GL::AbstractShaderProgram& program,
+	                        span<Stage const> stages);
+
+private:
+	[[nodiscard]] static Key key(span<Stage const> stages);
+
+	/* Links program from a cached binary, false when there is none or the driver refused it */
+	bool load(Magnum::GL::AbstractShaderProgram& program, Key const& key) const;
+
+	/* Must be called before linking a program that will be stored */
+	void prepare(Magnum::GL::AbstractShaderProgram& program) const;
+
+	void store(Magnum::GL::AbstractShaderProgram const& program, Key const& key) const;
+};
@@ -0,0 +1,248 @@
+#include "AabbTree.hpp"
+
+static f64 area(f64range3 const& box)
+{
+	const f64vec3 size = box.size();
+	return 2.0 * (size.x() * size.y() + size.y() * size.z() + size.z() * size.x());
+}
+
+static bool contains(f64range3 const& outer, f64range3 const& inner)
+{
+	for (u32 i = 0; i < 3; ++i)
+	{
+		if (inner.min()[i] < outer.min()[i] || inner.max()[i] > outer.max()[i])
+		{ return false; }
+	}
+	return true;
+}
+
+i32 AabbTree::insert(f64range3 const& box, f64 margin, entt::entity entity)
+{
+	const i32 leaf = allocate();
+	_nodes[leaf].box = f64range3{box.min() - f64vec3{margin}, box.max() + f64vec3{margin}};
+	_nodes[leaf].entity = entity;
+	_nodes[leaf].height = 0;
+	insertLeaf(leaf);
+	++_leafCount;
+	return leaf;
+}
+
+void AabbTree::remove(i32 leaf)
+{
+	CORRADE_INTERNAL_ASSERT(leaf >= 0 && std::size_t(leaf) < _nodes.size() && _nodes[leaf].isLeaf());
+	removeLeaf(leaf);
+	release(leaf);
+	--_leafCount;
+}
+
+bool AabbTree::move(i32 leaf, f64range3 const& box, f64 margin)
+{
+	if (contains(_nodes[leaf].box, box))
+	{ return false; }
+
+	removeLeaf(leaf);
+	_nodes[leaf].box = f64range3{box.min() - f64vec3{margin}, box.max() + f64vec3{margin}};
+	insertLeaf(leaf);
+	return true;
+}
+
+i32 AabbTree::allocate()
+{
+	i32 index;
+	if (_free != Null)
+	{
+		index = _free;
+		_free = _nodes[index].parent;
+	}
+	else
+	{
+		index = i32(_nodes.size());
+		_nodes.emplace_back();
+	}
+
+	_nodes[index] = Node{};
+	_nodes[index].height = 0;
+	return index;
+}
+
+void AabbTree::release(i32 index)
+{
+	_nodes[index] = Node{};
+	_nodes[index].parent = _free;
+	_free = index;
+}
+
+void AabbTree::insertLeaf(i32 leaf)
+{
+	if (_root == Null)
+	{
+		_root = leaf;
+		_nodes[leaf].parent = Null;
+		return;
+	}
+
+	/* Descend towards the sibling with the cheapest surface area increase */
+	const f64range3 leafBox = _nodes[leaf].box;
+	i32 index = _root;
+	while (!_nodes[index].isLeaf())
+	{
+		Node const& node = _nodes[index];
+		const f64 combinedArea = area(Magnum::Math::join(node.box, leafBox));
+
+		const f64 cost = 2.0 * combinedArea;
+		const f64 inheritanceCost = 2.0 * (combinedArea - area(node.box));
+
+		auto descendCost = [this, &leafBox, inheritanceCost](i32 child)
+		{
+			Node const& c = _nodes[child];
+			const f64 joined = area(Magnum::Math::join(leafBox, c.box));
+			return (c.isLeaf() ? joined : joined - area(c.box)) + inheritanceCost;
+		};
+		const f64 cost1 = descendCost(node.child1), cost2 = descendCost(node.child2);
+
+		if (cost < cost1 && cost < cost2)
+		{ break; }
+
+		index = cost1 < cost2 ? node.child1 : node.child2;
+	}
+
+	const i32 sibling = index;
+	const i32 oldParent = _nodes[sibling].parent;
+	const i32 newParent = allocate();
+
+	Node& parent = _nodes[newParent];
+	parent.parent = oldParent;
+	parent.box = Magnum::Math::join(leafBox, _nodes[sibling].box);
+	parent.height = _nodes[sibling].height + 1;
+	parent.child1 = sibling;
+	parent.child2 = leaf;
+
+	if (oldParent != Null)
+	{
+		if (_nodes[oldParent].child1 == sibling)
+		{ _nodes[oldParent].child1 = newParent; }
+		else
+		{ _nodes[oldParent].child2 = newParent; }
+	}
+	else
+	{
+		_root = newParent;
+	}
+	_nodes[sibling].parent = newParent;
+	_nodes[leaf].parent = newParent;
+
+	refit(newParent);
+}
+
+void AabbTree::removeLeaf(i32 leaf)
+{
+	if (leaf == _root)
+	{
+		_root = Null;
+		return;
+	}
+
+	const i32 parent = _nodes[leaf].parent;
+	const i32 grandParent = _nodes[parent].parent;
+	const i32 sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+
+	if (grandParent != Null)
+	{
+		if (_nodes[grandParent].child1 == parent)
+		{ _nodes[grandParent].child1 = sibling; }
+		else
+		{ _nodes[grandParent].child2 = sibling; }
+		_nodes[sibling].parent = grandParent;
+		release(parent);
+
+		refit(grandParent);
+	}
+	else
+	{
+		_root = sibling;
+		_nodes[sibling].parent = Null;
+		release(parent);
+	}
+}
+
+void AabbTree::refit(i32 index)
+{
+	while (index != Null)
+	{
+		index = balance(index);
+
+		Node& node = _nodes[index];
+		Node const& child1 = _nodes[node.child1];
+		Node const& child2 = _nodes[node.child2];
+		node.height = 1 + std::max(child1.height, child2.height);
+		node.box = Magnum::Math::join(child1.box, child2.box);
+
+		index = node.parent;
+	}
+}
+
+i32 AabbTree::balance(i32 iA)
+{
+	Node& a = _nodes[iA];
+	if (a.isLeaf() || a.height < 2)
+	{ return iA; }
+
+	const i32 iB = a.child1, iC = a.child2;
+	Node& b = _nodes[iB];
+	Node& c = _nodes[iC];
+	const i32 difference = c.height - b.height;
+
+	/* Rotates the taller child up in place of a, a takes over the shorter grandchild */
+	auto rotate = [this, iA, &a](i32 iUp, Node& up, Node& other, bool upWasChild1)
+	{
+		const i32 iF = up.child1, iG = up.child2;
+		Node& f = _nodes[iF];
+		Node& g = _nodes[iG];
+
+		up.child1 = iA;
+		up.parent = a.parent;
+		a.parent = iUp;
+
+		if (up.parent != Null)
+		{
+			if (_nodes[up.parent].child1 == iA)
+			{ _nodes[up.parent].child1 = iUp; }
+			else
+			{ _nodes[up.parent].child2 = iUp; }
+		}
+		else
+		{
+			_root = iUp;
+		}
+
+		const bool keepF = f.height > g.height;
+		const i32 iKept = keepF ? iF : iG, iGiven = keepF ? iG : iF;
+		Node& kept = keepF ? f : g;
+		Node& given = keepF ? g : f;
+
+		up.child2 = iKept;
+		if (upWasChild1)
+		{ a.child1 = iGiven; }
+		else
+		{ a.child2 = iGiven; }
+		given.parent = iA;
+
+		a.box = Magnum::Math::join(other.box, given.box);
+		up.box = Magnum::Math::join(a.box, kept.box);
+		a.height = 1 + std::max(other.height, given.height);
+		up.height = 1 + std::max(a.height, kept.height);
+	};
+
+	if (difference > 1)
+	{
+		rotate(iC, c, b, false);
+		return iC;
+	}
+	if (difference < -1)
+	{
+		rotate(iB, b, c, true);
+		return iB;
+	}
+
+	return iA;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <Corrade/Utility/Assert.h>
+#include <entt/entity/entity.hpp>
+
+#include "../../Types.hpp"
+
+/* Dynamic bounding volume hierarchy over fattened boxes, kept balanced with tree rotations. Leaves only get
+ * reinserted when their tight box escapes the fat one, so slowly moving entities cost nothing. */
+class AabbTree
+{
+public:
+	enum class Overlap : u8
+	{
+		Outside,
+		Intersects,
+		Inside
+	};
+
+	static constexpr i32 Null = -1;
+
+	AabbTree() = default;
+
+	[[nodiscard]] std::size_t leafCount() const
+	{ return _leafCount; }
+
+	[[nodiscard]] i32 height() const
+	{ return _root == Null ? 0 : _nodes[_root].height; }
+
+	[[nodiscard]] f64range3 const& fatBox(i32 leaf) const
+	{ return _nodes[leaf].box; }
+
+	[[nodiscard]] entt::entity entity(i32 leaf) const
+	{ return _nodes[leaf].entity; }
+
+	/* Inserts box grown by margin on every side and returns its leaf */
+	i32 insert(f64range3 const& box, f64 margin, entt::entity entity);
+
+	void remove(i32 leaf);
+
+	/* Reinserts the leaf when box left its fat box, returns whether it did */
+	bool move(i32 leaf, f64range3 const& box, f64 margin);
+
+	/* Walks every node overlap(box) does not reject. Inside accepts the whole subtree without testing it further,
+	 * visit(leaf) is called for every accepted leaf. */
+	template<class OverlapFn, class VisitFn>
+	void query(OverlapFn&& overlap, VisitFn&& visit) const
+	{
+		if (_root == Null)
+		{ return; }
+
+		array<std::pair<i32, bool>, 128> stack;
+		std::size_t size = 0;
+		stack[size++] = {_root, false};
+
+		while (size > 0)
+		{
+			auto [index, inside] = stack[--size];
+			Node const& node = _nodes[index];
+
+			if (!inside)
+			{
+				const Overlap result = overlap(node.box);
+				if (result == Overlap::Outside)
+				{ continue; }
+				inside = result == Overlap::Inside;
+			}
+
+			if (node.isLeaf())
+			{
+				visit(index);
+			}
+			else
+			{
+				CORRADE_INTERNAL_ASSERT(size + 2 <= stack.size());
+				stack[size++] = {node.child2, inside};
+				stack[size++] = {node.child1, inside};
+			}
+		}
+	}
+
+	template<class VisitFn>
+	void forEachLeaf(VisitFn&& visit) const
+	{
+		query([](f64range3 const&)
+		      { return Overlap::Inside; }, std::forward<VisitFn>(visit));
+	}
+
+private:
+	struct Node
+	{
+		f64range3 box{};
+		entt::entity entity{entt::null};
+		/* Next free node when the node is unused */
+		i32 parent{Null};
+		i32 child1{Null}, child2{Null};
+		/* 0 for leaves, -1 for unused nodes */
+		i32 height{-1};
+
+		[[nodiscard]] bool isLeaf() const
+		{ return child1 == Null; }
+	};
+
+	vector<Node> _nodes{};
+	i32 _root{Null}, _free{Null};
+	std::size_t _leafCount{0};
+
+	i32 allocate();
+
+	void release(i32 index);
+
+	void insertLeaf(i32 leaf);
+
+	void removeLeaf(i32 leaf);
+
+	/* Refits boxes and heights from index up to the root, rotating where unbalanced */
+	void refit(i32 index);
+
+	i32 balance(i32 index);
+};
@@ -0,0 +1,276 @@
+#include <algorithm>
+
+#include "SpatialIndex.hpp"
+
+using Overlap = AabbTree::Overlap;
+
+static Overlap classifyFrustum(Frustum const& frustum, f64vec3 const& origin, f64range3 const& box)
+{
+	const f32vec3 min{box.min() - origin}, max{box.max() - origin};
+
+	Overlap result = Overlap::Inside;
+	for (f32vec4 const& plane: frustum.planes())
+	{
+		const f32vec3 normal = plane.xyz();
+		f32vec3 positive, negative;
+		for (u32 i = 0; i < 3; ++i)
+		{
+			positive[i] = normal[i] >= 0.f ? max[i] : min[i];
+			negative[i] = normal[i] >= 0.f ? min[i] : max[i];
+		}
+
+		if (Magnum::Math::dot(normal, positive) + plane.w() < 0.f)
+		{ return Overlap::Outside; }
+		if (Magnum::Math::dot(normal, negative) + plane.w() < 0.f)
+		{ result = Overlap::Intersects; }
+	}
+	return result;
+}
+
+static Overlap classifySphere(f64vec3 const& center, f64 radius, f64range3 const& box)
+{
+	f64 nearest = 0.0, farthest = 0.0;
+	for (u32 i = 0; i < 3; ++i)
+	{
+		const f64 below = box.min()[i] - center[i], above = center[i] - box.max()[i];
+		const f64 outside = std::max({below, above, 0.0});
+		const f64 reach = std::max(center[i] - box.min()[i], box.max()[i] - center[i]);
+		nearest += outside * outside;
+		farthest += reach * reach;
+	}
+
+	const f64 radiusSqr = radius * radius;
+	if (nearest > radiusSqr)
+	{ return Overlap::Outside; }
+	return farthest <= radiusSqr ? Overlap::Inside : Overlap::Intersects;
+}
+
+static Overlap classifyBox(f64range3 const& query, f64range3 const& box)
+{
+	bool inside = true;
+	for (u32 i = 0; i < 3; ++i)
+	{
+		if (box.max()[i] < query.min()[i] || box.min()[i] > query.max()[i])
+		{ return Overlap::Outside; }
+		inside = inside && box.min()[i] >= query.min()[i] && box.max()[i] <= query.max()[i];
+	}
+	return inside ? Overlap::Inside : Overlap::Intersects;
+}
+
+/* Entry distance of the ray into box, or a negative value when it misses */
+static f64 intersectRay(SpatialIndex::Ray const& ray, f64range3 const& box)
+{
+	f64 entry = 0.0, exit = ray.length;
+	for (u32 i = 0; i < 3; ++i)
+	{
+		if (ray.direction[i] == 0.0)
+		{
+			if (ray.origin[i] < box.min()[i] || ray.origin[i] > box.max()[i])
+			{ return -1.0; }
+			continue;
+		}
+
+		const f64 inverse = 1.0 / ray.direction[i];
+		f64 t0 = (box.min()[i] - ray.origin[i]) * inverse, t1 = (box.max()[i] - ray.origin[i]) * inverse;
+		if (t0 > t1)
+		{ std::swap(t0, t1); }
+
+		entry = std::max(entry, t0);
+		exit = std::min(exit, t1);
+		if (exit < entry)
+		{ return -1.0; }
+	}
+	return entry;
+}
+
+namespace
+{
+	/* Proxies dropped since the last update, kept in the registry context so the listeners need no index */
+	struct SpatialRemovals
+	{
+		vector<std::pair<entt::entity, i32>> proxies{};
+	};
+
+	void markDirty(entt::registry& reg, entt::entity entity)
+	{ reg.emplace_or_replace<SpatialDirtyComponent>(entity); }
+
+	void dropProxy(entt::registry& reg, entt::entity entity)
+	{
+		reg.remove<SpatialDirtyComponent>(entity);
+		reg.remove<SpatialProxyComponent>(entity);
+	}
+
+	void queueRemoval(entt::registry& reg, entt::entity entity)
+	{ reg.ctx().get<SpatialRemovals>().proxies.emplace_back(entity, reg.get<SpatialProxyComponent>(entity).node); }
+}
+
+void SpatialIndex::connect(entt::registry& reg)
+{
+	if (!reg.ctx().contains<SpatialRemovals>())
+	{ reg.ctx().emplace<SpatialRemovals>(); }
+
+	reg.on_construct<MeshComponent>().connect<&markDirty>();
+	reg.on_update<MeshComponent>().connect<&markDirty>();
+	reg.on_destroy<MeshComponent>().connect<&dropProxy>();
+	reg.on_destroy<SpatialProxyComponent>().connect<&queueRemoval>();
+
+	for (auto entity: reg.view<MeshComponent>(entt::exclude<SpatialProxyComponent>))
+	{ markDirty(reg, entity); }
+}
+
+void SpatialIndex::update(entt::registry& reg, TransformSystem const& transforms)
+{
+	if (auto* removals = reg.ctx().find<SpatialRemovals>())
+	{
+		for (auto [entity, node]: removals->proxies)
+		{ remove(entity, node); }
+		removals->proxies.clear();
+	}
+
+	/* New meshes and changed bounds, a leaf is rebuilt rather than moved since its margin depends on the radius */
+	for (auto entity: reg.view<SpatialDirtyComponent>())
+	{
+		if (!reg.all_of<TransformComponent, MeshComponent>(entity))
+		{ continue; }
+
+		if (auto* proxy = reg.try_get<SpatialProxyComponent>(entity))
+		{
+			remove(entity, proxy->node);
+			proxy->node = insert(reg, entity);
+		}
+		else
+		{ reg.emplace<SpatialProxyComponent>(entity, insert(reg, entity)); }
+	}
+	reg.clear<SpatialDirtyComponent>();
+
+	for (auto entity: transforms.changed())
+	{
+		if (!reg.valid(entity))
+		{ continue; }
+
+		auto [transform, mesh, proxy] = reg.try_get<TransformComponent, MeshComponent, SpatialProxyComponent>(entity);
+		if (!transform || !mesh || !proxy || proxy->node == AabbTree::Null)
+		{ continue; }
+
+		const f64vec3 center = transform->world_transform().transformPoint(f64vec3{mesh->scaled_center()});
+		const f64vec3 extent{f64(mesh->scaled_radius())};
+		_tree.move(proxy->node, f64range3{center - extent, center + extent}, FatMargin * extent.x());
+	}
+}
+
+i32 SpatialIndex::insert(entt::registry& reg, entt::entity entity)
+{
+	auto const& [transform, mesh] = reg.get<TransformComponent, MeshComponent>(entity);
+	if (mesh.radius == f32const::inf())
+	{
+		_unbounded.push_back(entity);
+		return AabbTree::Null;
+	}
+
+	const f64vec3 center = transform.world_transform().transformPoint(f64vec3{mesh.scaled_center()});
+	const f64vec3 extent{f64(mesh.scaled_radius())};
+	return _tree.insert(f64range3{center - extent, center + extent}, FatMargin * extent.x(), entity);
+}
+
+void SpatialIndex::remove(entt::entity entity, i32 node)
+{
+	if (node != AabbTree::Null)
+	{ _tree.remove(node); }
+	else
+	{ std::erase(_unbounded, entity); }
+}
+
+void SpatialIndex::queryFrustum(Frustum const& frustum, f64vec3 const& origin, vector<entt::entity>& out) const
+{
+	out.insert(out.end(), _unbounded.begin(), _unbounded.end());
+	_tree.query([&frustum, &origin](f64range3 const& box)
+	            { return classifyFrustum(frustum, origin, box); },
+	            [this, &out](i32 leaf)
+	            { out.push_back(_tree.entity(leaf)); });
+}
+
+void SpatialIndex::querySphere(f64vec3 const& center, f64 radius, vector<entt::entity>& out) const
+{
+	out.insert(out.end(), _unbounded.begin(), _unbounded.end());
+	_tree.query([&center, radius](f64range3 const& box)
+	            { return classifySphere(center, radius, box); },
+	            [this, &out](i32 leaf)
+	            { out.push_back(_tree.entity(leaf)); });
+}
+
+void SpatialIndex::queryBox(f64range3 const& box, vector<entt::entity>& out) const
+{
+	out.insert(out.end(), _unbounded.begin(), _unbounded.end());
+	_tree.query([&box](f64range3 const& node)
+	            { return classifyBox(box, node); },
+	            [this, &out](i32 leaf)
+	            { out.push_back(_tree.entity(leaf)); });
+}
+
+void SpatialIndex::raycast(Ray const& ray, vector<RayHit>& out) const
+{
+	const std::size_t first = out.size();
+	for (auto entity: _unbounded)
+	{ out.push_back({entity, 0.0}); }
+
+	_tree.query([&ray](f64range3 const& box)
+	            { return intersectRay(ray, box) < 0.0 ? Overlap::Outside : Overlap::Intersects; },
+	            [this, &ray, &out](i32 leaf)
+	            { out.push_back({_tree.entity(leaf), intersectRay(ray, _tree.fatBox(leaf))}); });
+
+	std::sort(out.begin() + std::ptrdiff_t(first), out.end(), [](RayHit const& a, RayHit const& b)
+	{ return a.distance < b.distance; });
+}
+
+template<class T, class Fn>
+void SpatialIndex::batch(std::size_t count, SpatialBatch<T>& out, ThreadPool* pool, Fn&& fn)
+{
+	vector<vector<T>> results(count);
+	if (pool)
+	{
+		pool->parallelFor(count, 1, [&results, &fn](std::size_t first, std::size_t last)
+		{
+			for (std::size_t i = first; i < last; ++i)
+			{ fn(i, results[i]); }
+		});
+	}
+	else
+	{
+		for (std::size_t i = 0; i < count; ++i)
+		{ fn(i, results[i]); }
+	}
+
+	out._values.clear();
+	out._offsets.assign(1, 0);
+	for (auto const& result: results)
+	{
+		out._values.insert(out._values.end(), result.begin(), result.end());
+		out._offsets.push_back(out._values.size());
+	}
+}
+
+void SpatialIndex::queryFrustums(span<Frustum const> frustums, f64vec3 const& origin,
+                                 SpatialBatch<entt::entity>& out, ThreadPool* pool) const
+{
+	batch(frustums.size(), out, pool, [this, &frustums, &origin](std::size_t i, vector<entt::entity>& result)
+	{ queryFrustum(frustums[i], origin, result); });
+}
+
+void SpatialIndex::querySpheres(span<std::pair<f64vec3, f64> const> spheres, SpatialBatch<entt::entity>& out,
+                                ThreadPool* pool) const
+{
+	batch(spheres.size(), out, pool, [this, &spheres](std::size_t i, vector<entt::entity>& result)
+	{ querySphere(spheres[i].first, spheres[i].second, result); });
+}
+
+void SpatialIndex::queryBoxes(span<f64range3 const> boxes, SpatialBatch<entt::entity>& out, ThreadPool* pool) const
+{
+	batch(boxes.size(), out, pool, [this, &boxes](std::size_t i, vector<entt::entity>& result)
+	{ queryBox(boxes[i], result); });
+}
+
+void SpatialIndex::raycasts(span<Ray const> rays, SpatialBatch<RayHit>& out, ThreadPool* pool) const
+{
+	batch(rays.size(), out, pool, [this, &rays](std::size_t i, vector<RayHit>& result)
+	{ raycast(rays[i], result); });
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <entt/entity/registry.hpp>
+
+#include "../../jobs/ThreadPool.hpp"
+#include "TransformSystem.hpp"
+#include "../Components.hpp"
+#include "../../Types.hpp"
+#include "../Frustum.hpp"
+#include "AabbTree.hpp"
+
+/* Tree leaf of an indexed entity, AabbTree::Null when its mesh has no finite bounds */
+struct SpatialProxyComponent
+{
+	i32 node{AabbTree::Null};
+};
+
+/* Set by registry signals on entities whose MeshComponent was emplaced, replaced or patched */
+struct SpatialDirtyComponent
+{};
+
+/* Results of a batched query, values()[i] are the matches of the i-th query */
+template<class T>
+class SpatialBatch
+{
+	vector<T> _values{};
+	vector<std::size_t> _offsets{};
+
+	friend class SpatialIndex;
+
+public:
+	[[nodiscard]] std::size_t size() const
+	{ return _offsets.empty() ? 0 : _offsets.size() - 1; }
+
+	[[nodiscard]] span<T const> operator[](std::size_t query) const
+	{ return span<T const>{_values}.subspan(_offsets[query], _offsets[query + 1] - _offsets[query]); }
+};
+
+/* World space bounding volume hierarchy over every entity with a TransformComponent and a MeshComponent, built from
+ * the mesh bounding spheres in double precision. update() only touches the entities TransformSystem::changed() lists,
+ * plus those whose MeshComponent was added, removed, replaced or patched, as reported by the registry signals
+ * connect() hooks; changing the center, radius or scale of a mesh in place goes unnoticed until it gets patched.
+ * Leaves are fattened so small motions do not even reinsert them.
+ *
+ * Matches are tested against the fattened boxes and are therefore conservative. Entities whose mesh has an infinite
+ * radius match every volume query and every ray at distance 0. */
+class SpatialIndex
+{
+	AabbTree _tree{};
+	vector<entt::entity> _unbounded{};
+
+public:
+	struct Ray
+	{
+		f64vec3 origin{};
+		f64vec3 direction{};
+		/* In units of direction */
+		f64 length{f64const::inf()};
+	};
+
+	struct RayHit
+	{
+		entt::entity entity{entt::null};
+		/* Where the ray enters the leaf box, in units of the ray direction */
+		f64 distance{0.0};
+	};
+
+	/* Leaves are grown by this fraction of their radius on every side */
+	static constexpr f64 FatMargin = 0.25;
+
+	SpatialIndex() = default;
+
+	/* Hooks the MeshComponent signals of reg and marks the meshes already there. The listeners only touch the
+	 * registry, so moving the index afterwards is fine. */
+	static void connect(entt::registry& reg);
+
+	/* Must run after TransformSystem::update() and before TransformSystem::endFrame() */
+	void update(entt::registry& reg, TransformSystem const& transforms);
+
+	[[nodiscard]] AabbTree const& tree() const
+	{ return _tree; }
+
+	[[nodiscard]] std::size_t size() const
+	{ return _tree.leafCount() + _unbounded.size(); }
+
+	/* frustum is relative to origin, as built from the origin-relative matrices of TransformSystem */
+	void queryFrustum(Frustum const& frustum, f64vec3 const& origin, vector<entt::entity>& out) const;
+
+	void querySphere(f64vec3 const& center, f64 radius, vector<entt::entity>& out) const;
+
+	void queryBox(f64range3 const& box, vector<entt::entity>& out) const;
+
+	/* Appends every hit sorted by distance */
+	void raycast(Ray const& ray, vector<RayHit>& out) const;
+
+	/* Batched variants run one query per job when a pool is given */
+	void queryFrustums(span<Frustum const> frustums, f64vec3 const& origin, SpatialBatch<entt::entity>& out,
+	                   ThreadPool* pool = nullptr) const;
+
+	void querySpheres(span<std::pair<f64vec3, f64> const> spheres, SpatialBatch<entt::entity>& out,
+	                  ThreadPool* pool = nullptr) const;
+
+	void queryBoxes(span<f64range3 const> boxes, SpatialBatch<entt::entity>& out, ThreadPool* pool = nullptr) const;
+
+	void raycasts(span<Ray const> rays, SpatialBatch<RayHit>& out, ThreadPool* pool = nullptr) const;
+
+private:
+	/* New tree leaf of entity, AabbTree::Null after adding it to the unbounded ones instead */
+	i32 insert(entt::registry& reg, entt::entity entity);
+
+	void remove(entt::entity entity, i32 node);
+
+	template<class T, class Fn>
+	static void batch(std::size_t count, SpatialBatch<T>& out, ThreadPool* pool, Fn&& fn);
+};
@@ -0,0 +1,197 @@
+#include <Corrade/Utility/Assert.h>
+
+#include "TransformStore.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ASTEROPE_TRANSFORM_SSE
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX__)
+#define ASTEROPE_TRANSFORM_AVX
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	struct Input
+	{
+		const f32* rx, * ry, * rz, * rw;
+		const f32* dx, * dy, * dz, * dw;
+	};
+
+	struct ScalarLanes
+	{
+		using V = f32;
+		static constexpr std::size_t Width = 1;
+
+		static V load(const f32* p)
+		{ return *p; }
+
+		static V set(f32 f)
+		{ return f; }
+
+		static V add(V a, V b)
+		{ return a + b; }
+
+		static V sub(V a, V b)
+		{ return a - b; }
+
+		static V mul(V a, V b)
+		{ return a * b; }
+
+		static void store(f32* out, V const (& m)[12])
+		{
+			for (std::size_t c = 0; c < 4; ++c)
+			{
+				out[c * 4 + 0] = m[c * 3 + 0];
+				out[c * 4 + 1] = m[c * 3 + 1];
+				out[c * 4 + 2] = m[c * 3 + 2];
+				out[c * 4 + 3] = c == 3 ? 1.f : 0.f;
+			}
+		}
+	};
+
+#ifdef ASTEROPE_TRANSFORM_SSE
+	/* Four lanes hold one column component for four entities, a 4x4 transpose turns them back into columns */
+	inline void storeColumns(f32* out, __m128 const (& m)[12])
+	{
+		for (std::size_t c = 0; c < 4; ++c)
+		{
+			__m128 a = m[c * 3 + 0], b = m[c * 3 + 1], d = m[c * 3 + 2];
+			__m128 w = c == 3 ? _mm_set1_ps(1.f) : _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(a, b, d, w);
+			_mm_storeu_ps(out + 0 * 16 + c * 4, a);
+			_mm_storeu_ps(out + 1 * 16 + c * 4, b);
+			_mm_storeu_ps(out + 2 * 16 + c * 4, d);
+			_mm_storeu_ps(out + 3 * 16 + c * 4, w);
+		}
+	}
+
+	struct SseLanes
+	{
+		using V = __m128;
+		static constexpr std::size_t Width = 4;
+
+		static V load(const f32* p)
+		{ return _mm_loadu_ps(p); }
+
+		static V set(f32 f)
+		{ return _mm_set1_ps(f); }
+
+		static V add(V a, V b)
+		{ return _mm_add_ps(a, b); }
+
+		static V sub(V a, V b)
+		{ return _mm_sub_ps(a, b); }
+
+		static V mul(V a, V b)
+		{ return _mm_mul_ps(a, b); }
+
+		static void store(f32* out, V const (& m)[12])
+		{ storeColumns(out, m); }
+	};
+#endif
+
+#ifdef ASTEROPE_TRANSFORM_AVX
+	struct AvxLanes
+	{
+		using V = __m256;
+		static constexpr std::size_t Width = 8;
+
+		static V load(const f32* p)
+		{ return _mm256_loadu_ps(p); }
+
+		static V set(f32 f)
+		{ return _mm256_set1_ps(f); }
+
+		static V add(V a, V b)
+		{ return _mm256_add_ps(a, b); }
+
+		static V sub(V a, V b)
+		{ return _mm256_sub_ps(a, b); }
+
+		static V mul(V a, V b)
+		{ return _mm256_mul_ps(a, b); }
+
+		static void store(f32* out, V const (& m)[12])
+		{
+			__m128 lo[12], hi[12];
+			for (std::size_t i = 0; i < 12; ++i)
+			{
+				lo[i] = _mm256_castps256_ps128(m[i]);
+				hi[i] = _mm256_extractf128_ps(m[i], 1);
+			}
+			storeColumns(out, lo);
+			storeColumns(out + 4 * 16, hi);
+		}
+	};
+#endif
+
+	/* Same math as DualQuaternion::toMatrix(), assuming a unit real part */
+	template<class L>
+	std::size_t convert(Input const& in, f32* out, std::size_t first, std::size_t last)
+	{
+		using V = typename L::V;
+		const V one = L::set(1.f), two = L::set(2.f);
+
+		std::size_t i = first;
+		for (; i + L::Width <= last; i += L::Width)
+		{
+			const V rx = L::load(in.rx + i), ry = L::load(in.ry + i), rz = L::load(in.rz + i), rw = L::load(in.rw + i);
+			const V dx = L::load(in.dx + i), dy = L::load(in.dy + i), dz = L::load(in.dz + i), dw = L::load(in.dw + i);
+
+			const V vx = L::mul(rx, two), vy = L::mul(ry, two), vz = L::mul(rz, two);
+			const V xx = L::mul(rx, vx), yy = L::mul(ry, vy), zz = L::mul(rz, vz);
+			const V xy = L::mul(rx, vy), xz = L::mul(rx, vz), yz = L::mul(ry, vz);
+			const V wx = L::mul(rw, vx), wy = L::mul(rw, vy), wz = L::mul(rw, vz);
+
+			/* translation = 2*(rw*dual.xyz - dw*real.xyz + cross(real.xyz, dual.xyz)) */
+			const V tx = L::mul(two, L::add(L::sub(L::mul(rw, dx), L::mul(dw, rx)),
+			                                L::sub(L::mul(ry, dz), L::mul(rz, dy))));
+			const V ty = L::mul(two, L::add(L::sub(L::mul(rw, dy), L::mul(dw, ry)),
+			                                L::sub(L::mul(rz, dx), L::mul(rx, dz))));
+			const V tz = L::mul(two, L::add(L::sub(L::mul(rw, dz), L::mul(dw, rz)),
+			                                L::sub(L::mul(rx, dy), L::mul(ry, dx))));
+
+			const V m[12]{
+					L::sub(L::sub(one, yy), zz), L::add(xy, wz), L::sub(xz, wy),
+					L::sub(xy, wz), L::sub(L::sub(one, xx), zz), L::add(yz, wx),
+					L::add(xz, wy), L::sub(yz, wx), L::sub(L::sub(one, xx), yy),
+					tx, ty, tz
+			};
+			L::store(out + i * 16, m);
+		}
+
+		return i;
+	}
+}
+
+void TransformStore::resize(std::size_t size)
+{
+	for (auto* v: {&_realX, &_realY, &_realZ, &_dualX, &_dualY, &_dualZ, &_dualW})
+	{ v->resize(size, 0.f); }
+	_realW.resize(size, 1.f);
+	_matrices.resize(size);
+}
+
+void TransformStore::updateMatrices(std::size_t first, std::size_t last)
+{
+	CORRADE_INTERNAL_ASSERT(first <= last && last <= size());
+	if (first == last)
+	{ return; }
+
+	const Input in{
+			_realX.data(), _realY.data(), _realZ.data(), _realW.data(),
+			_dualX.data(), _dualY.data(), _dualZ.data(), _dualW.data()
+	};
+	f32* out = _matrices.data()->data();
+
+#ifdef ASTEROPE_TRANSFORM_AVX
+	first = convert<AvxLanes>(in, out, first, last);
+#endif
+#ifdef ASTEROPE_TRANSFORM_SSE
+	first = convert<SseLanes>(in, out, first, last);
+#endif
+	convert<ScalarLanes>(in, out, first, last);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../../Types.hpp"
+
+/* Structure-of-arrays copy of the camera-relative world dual quaternions, one slot per TransformComponent in packed storage
+ * order, plus the 4x4 matrices they convert to. The conversion runs as one batched SIMD pass per frame so the
+ * render loops only read precomputed matrices. */
+class TransformStore
+{
+	vector<f32> _realX{}, _realY{}, _realZ{}, _realW{};
+	vector<f32> _dualX{}, _dualY{}, _dualZ{}, _dualW{};
+	vector<f32mat4> _matrices{};
+
+public:
+	TransformStore() = default;
+
+	void resize(std::size_t size);
+
+	[[nodiscard]] std::size_t size() const
+	{ return _matrices.size(); }
+
+	void set(std::size_t slot, f32dquat const& dq)
+	{
+		_realX[slot] = dq.real().vector().x();
+		_realY[slot] = dq.real().vector().y();
+		_realZ[slot] = dq.real().vector().z();
+		_realW[slot] = dq.real().scalar();
+		_dualX[slot] = dq.dual().vector().x();
+		_dualY[slot] = dq.dual().vector().y();
+		_dualZ[slot] = dq.dual().vector().z();
+		_dualW[slot] = dq.dual().scalar();
+	}
+
+	[[nodiscard]] f32dquat dualQuaternion(std::size_t slot) const
+	{
+		return f32dquat{f32quat{{_realX[slot], _realY[slot], _realZ[slot]}, _realW[slot]},
+		                f32quat{{_dualX[slot], _dualY[slot], _dualZ[slot]}, _dualW[slot]}};
+	}
+
+	[[nodiscard]] f32mat4 const& matrix(std::size_t slot) const
+	{ return _matrices[slot]; }
+
+	void updateMatrices()
+	{ updateMatrices(0, size()); }
+
+	void updateMatrices(std::size_t first, std::size_t last);
+};
@@ -0,0 +1,213 @@
+#include <Corrade/Utility/Assert.h>
+#include <algorithm>
+#include <atomic>
+
+#include "TransformSystem.hpp"
+
+static TransformComponent const* parentOf(entt::storage_for_t<TransformComponent> const& storage,
+                                          TransformComponent const& transform)
+{
+	if (transform.parent && storage.contains(transform.parent.entity()))
+	{
+		return &storage.get(transform.parent.entity());
+	}
+	else
+	{
+		return nullptr;
+	}
+}
+
+void TransformSystem::update(entt::registry& reg, ThreadPool* pool)
+{
+	auto& storage = reg.storage<TransformComponent>();
+	bool changed = false;
+
+	/* Entities were created or destroyed since the last sort, packed order no longer follows depth */
+	if (storage.size() != _entities.size() || !std::equal(_entities.begin(), _entities.end(), storage.data()))
+	{
+		rebuild(reg);
+		propagate(storage, pool, true, changed);
+	}
+	else if (!propagate(storage, pool, false, changed))
+	{
+		/* Something got reparented, sort again and recompute everything */
+		rebuild(reg);
+		propagate(storage, pool, true, changed);
+	}
+
+	if (!changed)
+	{ return; }
+
+	/* Collect the slots touched by this update and merge them in the frame list */
+	_updatedSlots.clear();
+	for (std::size_t i = 0; i < _entities.size(); ++i)
+	{
+		if (!_slotUpdated[i])
+		{ continue; }
+
+		_updatedSlots.push_back(i);
+		if (!_slotChanged[i])
+		{
+			_slotChanged[i] = 1;
+			_changed.push_back(_entities[i]);
+		}
+	}
+
+	/* A handful of moving entities is cheaper to convert run by run than with a full batch */
+	if (_updatedSlots.size() * 4 >= _entities.size())
+	{ updateMatrices(pool); }
+	else
+	{ updateMatrices(_updatedSlots); }
+}
+
+void TransformSystem::endFrame()
+{
+	std::fill(_slotChanged.begin(), _slotChanged.end(), 0);
+	_changed.clear();
+	_rebased = false;
+}
+
+void TransformSystem::setOrigin(entt::registry& reg, f64vec3 const& origin, ThreadPool* pool)
+{
+	auto& storage = reg.storage<TransformComponent>();
+	CORRADE_ASSERT(storage.size() == _entities.size(), "TransformSystem::setOrigin(): called before update()", );
+
+	_origin = origin;
+	_rebased = true;
+
+	auto process = [this, &storage](std::size_t first, std::size_t last)
+	{
+		for (std::size_t i = first; i < last; ++i)
+		{ _store.set(i, toRelative(storage.get(_entities[i])._world)); }
+	};
+
+	if (pool)
+	{ pool->parallelFor(_entities.size(), ParallelGrain, process); }
+	else
+	{ process(0, _entities.size()); }
+
+	updateMatrices(pool);
+}
+
+void TransformSystem::updateMatrices(ThreadPool* pool)
+{
+	if (pool)
+	{
+		pool->parallelFor(_store.size(), ParallelGrain, [this](std::size_t first, std::size_t last)
+		{ _store.updateMatrices(first, last); });
+	}
+	else
+	{
+		_store.updateMatrices();
+	}
+}
+
+void TransformSystem::updateMatrices(span<std::size_t const> slots)
+{
+	for (std::size_t i = 0; i < slots.size();)
+	{
+		std::size_t last = i + 1;
+		while (last < slots.size() && slots[last] == slots[last - 1] + 1)
+		{ ++last; }
+
+		_store.updateMatrices(slots[i], slots[last - 1] + 1);
+		i = last;
+	}
+}
+
+void TransformSystem::rebuild(entt::registry& reg)
+{
+	auto& storage = reg.storage<TransformComponent>();
+
+	const entt::entity* packed = storage.data();
+	for (std::size_t i = 0, size = storage.size(); i < size; ++i)
+	{
+		auto& transform = storage.get(packed[i]);
+		transform._depth = 0;
+		for (auto* parent = parentOf(storage, transform); parent; parent = parentOf(storage, *parent))
+		{
+			++transform._depth;
+			CORRADE_ASSERT(transform._depth < storage.size(), "TransformSystem::rebuild(): cycle in the transform hierarchy", );
+		}
+	}
+
+	/* EnTT sorts so that iterating from begin() follows the comparator, which walks the packed array backwards.
+	 * Sorting deepest first leaves the packed array itself root first. */
+	reg.sort<TransformComponent>([](TransformComponent const& lhs, TransformComponent const& rhs)
+	                             { return lhs._depth > rhs._depth; });
+
+	_entities.assign(storage.data(), storage.data() + storage.size());
+	_store.resize(_entities.size());
+	_slotUpdated.assign(_entities.size(), 0);
+	_slotChanged.assign(_entities.size(), 0);
+	_changed.clear();
+	_levels.clear();
+	for (std::size_t i = 0; i < _entities.size(); ++i)
+	{
+		auto& transform = storage.get(_entities[i]);
+		transform._slot = u32(i);
+		while (_levels.size() <= transform._depth)
+		{ _levels.push_back(i); }
+	}
+	_levels.push_back(_entities.size());
+}
+
+bool TransformSystem::propagate(entt::storage_for_t<TransformComponent>& storage, ThreadPool* pool, bool force,
+                                bool& changed)
+{
+	for (u32 depth = 0; depth < levelCount(); ++depth)
+	{
+		const std::size_t first = _levels[depth], count = _levels[depth + 1] - first;
+		std::atomic<bool> valid{true}, levelChanged{false};
+
+		auto process = [&](std::size_t begin, std::size_t end)
+		{
+			bool rangeChanged = false;
+			if (!propagateRange(storage, depth, first + begin, first + end, force, rangeChanged))
+			{ valid = false; }
+			if (rangeChanged)
+			{ levelChanged = true; }
+		};
+
+		if (pool)
+		{ pool->parallelFor(count, ParallelGrain, process); }
+		else
+		{ process(0, count); }
+
+		changed = changed || levelChanged;
+		if (!valid)
+		{ return false; }
+	}
+
+	return true;
+}
+
+bool TransformSystem::propagateRange(entt::storage_for_t<TransformComponent>& storage, u32 depth, std::size_t first,
+                                     std::size_t last, bool force, bool& changed)
+{
+	for (std::size_t i = first; i < last; ++i)
+	{
+		auto& transform = storage.get(_entities[i]);
+		auto const* parent = parentOf(storage, transform);
+
+		/* Reparented since the last sort, its parent may not have been processed yet */
+		if (transform._depth != depth || (parent ? parent->_depth + 1 != depth : depth != 0))
+		{ return false; }
+
+		const bool recompute = force || transform._dirty || (parent && parent->_updated);
+		if (recompute)
+		{
+			transform._world = parent ? parent->_world * transform._local : transform._local;
+			++transform._version;
+			_store.set(i, toRelative(transform._world));
+			changed = true;
+		}
+
+		_slotUpdated[i] = recompute;
+
+		transform._updated = recompute;
+		transform._dirty = false;
+	}
+
+	return true;
+}
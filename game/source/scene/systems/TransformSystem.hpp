@@ -0,0 +1,82 @@
+#pragma once
+
+#include <entt/entity/registry.hpp>
+
+#include "../../jobs/ThreadPool.hpp"
+#include "TransformStore.hpp"
+#include "../Components.hpp"
+#include "../../Types.hpp"
+
+/* Propagates local transforms down the parent hierarchy and caches the world transform of every entity.
+ * The TransformComponent storage is kept sorted by hierarchy depth, so every depth level is a contiguous
+ * slot range whose parents all live in the previous level. Levels are walked in order and each one is split
+ * across the thread pool; only subtrees whose local transform changed get recomputed.
+ *
+ * World transforms are composed in double precision. The store and the matrices hold them relative to a floating
+ * origin, normally close to the camera, so they keep full f32 precision at planetary distances.
+ *
+ * Every recomputed world transform bumps TransformComponent::version(), and the entities touched since the last
+ * endFrame() are listed by changed() so downstream systems can skip everything that stood still. */
+class TransformSystem
+{
+	vector<entt::entity> _entities{};
+	vector<std::size_t> _levels{};
+	TransformStore _store{};
+	f64vec3 _origin{};
+
+	vector<u8> _slotUpdated{}, _slotChanged{};
+	vector<std::size_t> _updatedSlots{};
+	vector<entt::entity> _changed{};
+	bool _rebased{false};
+
+public:
+	/* Smallest slot range handed to a worker, below that a level runs on the calling thread */
+	static constexpr std::size_t ParallelGrain = 1024;
+
+	TransformSystem() = default;
+
+	void update(entt::registry& reg, ThreadPool* pool = nullptr);
+
+	/* Clears the changed() list and the rebased() flag */
+	void endFrame();
+
+	/* Entities whose world transform changed since the last endFrame(), in no particular order */
+	[[nodiscard]] span<entt::entity const> changed() const
+	{ return _changed; }
+
+	/* The origin moved since the last endFrame(), every origin-relative transform changed with it */
+	[[nodiscard]] bool rebased() const
+	{ return _rebased; }
+
+	/* Moves the floating origin and refreshes every origin-relative transform, update() has to run first */
+	void setOrigin(entt::registry& reg, f64vec3 const& origin, ThreadPool* pool = nullptr);
+
+	[[nodiscard]] f64vec3 const& origin() const
+	{ return _origin; }
+
+	/* Origin-relative world matrix converted during the last update() */
+	[[nodiscard]] f32mat4 const& matrix(TransformComponent const& transform) const
+	{ return _store.matrix(transform._slot); }
+
+	/* Origin-relative world transform */
+	[[nodiscard]] f32dquat relative(TransformComponent const& transform) const
+	{ return _store.dualQuaternion(transform._slot); }
+
+	[[nodiscard]] std::size_t levelCount() const
+	{ return _levels.empty() ? 0 : _levels.size() - 1; }
+
+private:
+	[[nodiscard]] f32dquat toRelative(f64dquat const& world) const
+	{ return f32dquat{f64dquat::translation(-_origin) * world}; }
+
+	void rebuild(entt::registry& reg);
+
+	void updateMatrices(ThreadPool* pool);
+
+	void updateMatrices(span<std::size_t const> slots);
+
+	bool propagate(entt::storage_for_t<TransformComponent>& storage, ThreadPool* pool, bool force, bool& changed);
+
+	bool propagateRange(entt::storage_for_t<TransformComponent>& storage, u32 depth, std::size_t first,
+	                    std::size_t last, bool force, bool& changed);
+};